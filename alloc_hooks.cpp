@@ -0,0 +1,130 @@
+
+// Replacement global allocation functions which report every allocation to
+// aoc::memory. Only built with -DAOC_TRACK_ALLOCATIONS=ON. Sizes are taken
+// from malloc_usable_size(), so that unsized deletes are counted too, which
+// makes this glibc-specific.
+
+#include <malloc.h>
+#include <stdlib.h>
+
+import aoc;
+
+namespace {
+
+auto allocate(std::size_t size, std::size_t align) noexcept -> void*
+{
+    size = std::max(size, 1uz);
+    void* ptr = align > alignof(std::max_align_t)
+        ? ::aligned_alloc(align, (size + align - 1) / align * align)
+        : ::malloc(size);
+    if (ptr != nullptr) {
+        aoc::memory::record_allocation(::malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+auto allocate_or_throw(std::size_t size, std::size_t align) -> void*
+{
+    while (true) {
+        if (void* ptr = allocate(size, align)) { return ptr; }
+        if (auto handler = std::get_new_handler()) {
+            handler();
+        } else {
+            throw std::bad_alloc();
+        }
+    }
+}
+
+void deallocate(void* ptr) noexcept
+{
+    if (ptr == nullptr) { return; }
+    aoc::memory::record_deallocation(::malloc_usable_size(ptr));
+    ::free(ptr);
+}
+
+} // namespace
+
+auto operator new(std::size_t size) -> void*
+{
+    return allocate_or_throw(size, 0);
+}
+
+auto operator new[](std::size_t size) -> void*
+{
+    return allocate_or_throw(size, 0);
+}
+
+auto operator new(std::size_t size, std::align_val_t align) -> void*
+{
+    return allocate_or_throw(size, static_cast<std::size_t>(align));
+}
+
+auto operator new[](std::size_t size, std::align_val_t align) -> void*
+{
+    return allocate_or_throw(size, static_cast<std::size_t>(align));
+}
+
+auto operator new(std::size_t size, std::nothrow_t const&) noexcept -> void*
+{
+    return allocate(size, 0);
+}
+
+auto operator new[](std::size_t size, std::nothrow_t const&) noexcept -> void*
+{
+    return allocate(size, 0);
+}
+
+auto operator new(std::size_t size, std::align_val_t align,
+                  std::nothrow_t const&) noexcept -> void*
+{
+    return allocate(size, static_cast<std::size_t>(align));
+}
+
+auto operator new[](std::size_t size, std::align_val_t align,
+                    std::nothrow_t const&) noexcept -> void*
+{
+    return allocate(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::nothrow_t const&) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t,
+                     std::nothrow_t const&) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t,
+                       std::nothrow_t const&) noexcept
+{
+    deallocate(ptr);
+}
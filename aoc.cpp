@@ -1,3 +1,30 @@
+module;
+
+#if __has_include(<linux/perf_event.h>)
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    define AOC_HAVE_PERF_EVENTS 1
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+#    define AOC_HAVE_AVX2_KERNELS 1
+#endif
+
+#if __has_include(<sys/mman.h>)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define AOC_HAVE_MMAP 1
+#endif
+
+#if __has_include(<sys/resource.h>)
+#    include <sys/resource.h>
+#    define AOC_HAVE_GETRUSAGE 1
+#endif
 
 export module aoc;
 
@@ -77,12 +104,373 @@ constexpr auto parse = []<flux::iterable F>
     requires std::same_as<flux::iterable_value_t<F>, char>
 (F&& seq) static -> I { return try_parse<I>(std::forward<F&&>(seq)).value(); };
 
+// A forward-only cursor over some text, for parsing lines with a fixed
+// structure in a single pass without building any temporaries. Spaces
+// (but not newlines) are skipped before each token. Failed extractions
+// throw, like parse() does.
+export class scanner {
+public:
+    constexpr explicit scanner(std::string_view text) : text_(text) {}
+
+    constexpr auto at_end() const -> bool { return pos_ == text_.size(); }
+
+    constexpr auto remaining() const -> std::string_view
+    {
+        return text_.substr(pos_);
+    }
+
+    constexpr auto skip_spaces() -> scanner&
+    {
+        while (!at_end() && is_space(text_[pos_])) { ++pos_; }
+        return *this;
+    }
+
+    // Skips spaces and newlines, so `!sc.skip_whitespace().at_end()` is the
+    // condition for a loop over (non-blank) lines
+    constexpr auto skip_whitespace() -> scanner&
+    {
+        while (!at_end() && (is_space(text_[pos_]) || text_[pos_] == '\n')) {
+            ++pos_;
+        }
+        return *this;
+    }
+
+    // True at a newline or the end of the text, ignoring trailing spaces
+    constexpr auto at_eol() -> bool
+    {
+        skip_spaces();
+        return at_end() || text_[pos_] == '\n';
+    }
+
+    // Consumes `c` if it comes next
+    constexpr auto consume(char c) -> bool
+    {
+        if (skip_spaces().at_end() || text_[pos_] != c) { return false; }
+        ++pos_;
+        return true;
+    }
+
+    constexpr auto expect(char c) -> scanner&
+    {
+        if (!consume(c)) { throw std::runtime_error("scanner: unexpected"); }
+        return *this;
+    }
+
+    template <flux::num::integral I>
+    constexpr auto try_read() -> std::optional<I>
+    {
+        skip_spaces();
+        auto const start = pos_;
+        I sign = 1;
+        if (!at_end() && (text_[pos_] == '-' || text_[pos_] == '+')) {
+            if constexpr (flux::num::signed_integral<I>) {
+                if (text_[pos_] == '-') { sign = -1; }
+            } else if (text_[pos_] == '-') {
+                return std::nullopt;
+            }
+            ++pos_;
+        }
+
+        std::optional<I> value;
+        for (; !at_end() && is_digit(text_[pos_]); ++pos_) {
+            value = 10 * value.value_or(0) + (text_[pos_] - '0');
+        }
+        if (!value) {
+            pos_ = start;
+            return std::nullopt;
+        }
+        return *value * sign;
+    }
+
+    template <flux::num::integral I>
+    constexpr auto read() -> I
+    {
+        return try_read<I>().value();
+    }
+
+    // A run of letters and digits
+    constexpr auto read_word() -> std::string_view
+    {
+        skip_spaces();
+        auto const start = pos_;
+        while (!at_end() && is_word_char(text_[pos_])) { ++pos_; }
+        if (pos_ == start) { throw std::runtime_error("scanner: no word"); }
+        return text_.substr(start, pos_ - start);
+    }
+
+    // Everything up to the next newline, which is consumed but not returned
+    constexpr auto read_line() -> std::string_view
+    {
+        auto const start = pos_;
+        pos_ = std::min(text_.find('\n', pos_), text_.size());
+        auto const line = text_.substr(start, pos_ - start);
+        if (!at_end()) { ++pos_; }
+        return line;
+    }
+
+private:
+    static constexpr auto is_space(char c) -> bool
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    static constexpr auto is_digit(char c) -> bool
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    static constexpr auto is_word_char(char c) -> bool
+    {
+        return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+            || c == '_';
+    }
+
+    std::string_view text_;
+    std::size_t pos_ = 0;
+};
+
+static_assert([] {
+    scanner sc("12,-3 x: ab7 cd\n\n  4");
+    return sc.read<int>() == 12 && sc.expect(',').read<int>() == -3
+        && sc.read_word() == "x" && sc.consume(':') && sc.read_word() == "ab7"
+        && sc.read_word() == "cd" && sc.at_eol()
+        && sc.skip_whitespace().read<unsigned>() == 4 && sc.at_end();
+}());
+static_assert(not scanner("-1").try_read<unsigned>().has_value());
+static_assert(not scanner("+").try_read<int>().has_value());
+
 export constexpr auto string_from_file =
     [](const char* path) static -> std::string {
     std::ifstream file(path);
     return flux::to<std::string>(*file.rdbuf());
 };
 
+// A single-pass sequence of blocks of whole lines from a file, read in chunks
+// of about `chunk_size` bytes, so that memory use is bounded by the chunk
+// size plus the longest line. A partial line at the end of a chunk is
+// carried over into the next block. Only the last block of the file might
+// not end in a newline. Each element is a string_view which is only valid
+// until the next one is read.
+export class block_stream : public flux::inline_sequence_base<block_stream> {
+public:
+    explicit block_stream(char const* path, std::size_t chunk_size = 1 << 16)
+        : file_(path, std::ios::binary),
+          chunk_size_(chunk_size)
+    {}
+
+    // Empty, and so not equality comparable: cursors can't be copied back to
+    // an earlier block
+    struct cursor_type {};
+
+    struct flux_sequence_traits {
+        static auto first(block_stream& self) -> cursor_type
+        {
+            self.next_block();
+            return {};
+        }
+
+        static auto is_last(block_stream& self, cursor_type const&) -> bool
+        {
+            return self.done_;
+        }
+
+        static void inc(block_stream& self, cursor_type&) { self.next_block(); }
+
+        static auto read_at(block_stream& self, cursor_type const&)
+            -> std::string_view
+        {
+            return std::string_view(self.buffer_).substr(0, self.block_end_);
+        }
+    };
+
+private:
+    // Drops the current block, and reads until the buffer holds at least one
+    // more whole line, or the rest of the file
+    void next_block()
+    {
+        buffer_.erase(0, block_end_);
+
+        while (file_) {
+            auto const from = buffer_.size();
+            buffer_.resize(from + chunk_size_);
+            file_.read(buffer_.data() + from,
+                       static_cast<std::streamsize>(chunk_size_));
+            buffer_.resize(from + static_cast<std::size_t>(file_.gcount()));
+
+            // Anything before `from` has no newline in it, so this is the
+            // last newline we've read
+            auto const nl = buffer_.rfind('\n');
+            if (file_ && nl != std::string::npos) {
+                block_end_ = nl + 1;
+                return;
+            }
+        }
+
+        block_end_ = buffer_.size();
+        done_ = buffer_.empty();
+    }
+
+    std::ifstream file_;
+    std::size_t chunk_size_;
+    std::string buffer_;
+    std::size_t block_end_ = 0;
+    bool done_ = false;
+};
+
+// A single-pass sequence of the lines of a file, split out of the blocks of a
+// block_stream. Each element is a string_view which is only valid until the
+// next one is read.
+export class line_stream : public flux::inline_sequence_base<line_stream> {
+public:
+    explicit line_stream(char const* path, std::size_t chunk_size = 1 << 16)
+        : blocks_(path, chunk_size)
+    {}
+
+    // Empty, and so not equality comparable: cursors can't be copied back to
+    // an earlier line
+    struct cursor_type {};
+
+    struct flux_sequence_traits {
+        static auto first(line_stream& self) -> cursor_type
+        {
+            self.block_ = flux::first(self.blocks_);
+            if (!flux::is_last(self.blocks_, self.block_)) {
+                self.rest_ = flux::read_at(self.blocks_, self.block_);
+            }
+            self.next_line();
+            return {};
+        }
+
+        static auto is_last(line_stream& self, cursor_type const&) -> bool
+        {
+            return self.done_;
+        }
+
+        static void inc(line_stream& self, cursor_type&) { self.next_line(); }
+
+        static auto read_at(line_stream& self, cursor_type const&)
+            -> std::string_view
+        {
+            return self.line_;
+        }
+    };
+
+private:
+    // Takes the next line from the current block, moving on to the next block
+    // once this one is used up. Only the last block is ever empty.
+    void next_line()
+    {
+        if (rest_.empty()) {
+            if (!flux::is_last(blocks_, block_)) { flux::inc(blocks_, block_); }
+            if (flux::is_last(blocks_, block_)) {
+                done_ = true;
+                return;
+            }
+            rest_ = flux::read_at(blocks_, block_);
+        }
+
+        auto const nl = std::min(rest_.find('\n'), rest_.size());
+        line_ = rest_.substr(0, nl);
+        rest_.remove_prefix(std::min(nl + 1, rest_.size()));
+    }
+
+    block_stream blocks_;
+    block_stream::cursor_type block_{};
+    std::string_view rest_;
+    std::string_view line_;
+    bool done_ = false;
+};
+
+// A monotonic bump allocator for parsed inputs. Memory is handed out from a
+// few large blocks, and released all at once when the arena is destroyed.
+// Not thread-safe.
+export class arena {
+public:
+    explicit arena(std::size_t initial_size = 1 << 20)
+        : resource_(initial_size)
+    {}
+
+    arena(arena const&) = delete;
+    auto operator=(arena const&) -> arena& = delete;
+
+    auto resource() -> std::pmr::memory_resource* { return &resource_; }
+
+    template <typename T = std::byte>
+    auto allocator() -> std::pmr::polymorphic_allocator<T>
+    {
+        return &resource_;
+    }
+
+private:
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+// Allocates from an arena at run time. A default-constructed arena_allocator,
+// or any arena_allocator during constant evaluation, uses std::allocator
+// instead, so the same container types work in constexpr tests. Copies of a
+// container go back to std::allocator, so solvers can copy (and free) parsed
+// data without growing the arena or sharing it between threads.
+export template <typename T = std::byte>
+struct arena_allocator {
+    using value_type = T;
+
+    constexpr arena_allocator() = default;
+
+    constexpr arena_allocator(arena& a) noexcept : resource_(a.resource()) {}
+
+    template <typename U>
+    constexpr arena_allocator(arena_allocator<U> const& other) noexcept
+        : resource_(other.resource_)
+    {}
+
+    constexpr auto allocate(std::size_t n) -> T*
+    {
+        if consteval {
+            return std::allocator<T>{}.allocate(n);
+        } else {
+            if (resource_ == nullptr) {
+                return std::allocator<T>{}.allocate(n);
+            }
+            return static_cast<T*>(
+                resource_->allocate(n * sizeof(T), alignof(T)));
+        }
+    }
+
+    constexpr void deallocate(T* ptr, std::size_t n)
+    {
+        if consteval {
+            std::allocator<T>{}.deallocate(ptr, n);
+        } else {
+            if (resource_ == nullptr) {
+                std::allocator<T>{}.deallocate(ptr, n);
+            } else {
+                resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+            }
+        }
+    }
+
+    constexpr auto select_on_container_copy_construction() const
+        -> arena_allocator
+    {
+        return {};
+    }
+
+    friend constexpr auto operator==(arena_allocator const&,
+                                     arena_allocator const&) -> bool = default;
+
+private:
+    template <typename>
+    friend struct arena_allocator;
+
+    std::pmr::memory_resource* resource_ = nullptr;
+};
+
+export template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+export using arena_string
+    = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
 export struct timer {
     using clock = std::chrono::high_resolution_clock;
 
@@ -108,6 +496,1328 @@ constexpr auto timed(F&& f, Args&&... args)
             t.elapsed<D>()};
 }
 
+// The splitmix64 generator. The standard distributions are
+// implementation-defined, so this rolls its own to give the same numbers
+// from the same seed everywhere.
+export struct splitmix64 {
+    std::uint64_t state;
+
+    constexpr auto next() -> std::uint64_t
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [lo, hi], give or take a little modulo bias
+    constexpr auto between(std::uint64_t lo, std::uint64_t hi) -> std::uint64_t
+    {
+        return lo + next() % (hi - lo + 1);
+    }
+
+    constexpr auto chance(double p) -> bool
+    {
+        return double(next() >> 11) * 0x1p-53 < p;
+    }
+};
+
+// A fixed pool of worker threads. Each worker owns a deque of tasks: it pops
+// from the back of its own deque and, when that runs dry, steals from the
+// front of the others'. Tasks submitted from outside the pool are dealt out
+// round-robin.
+export class thread_pool {
+public:
+    explicit thread_pool(
+        unsigned n_threads = std::max(1u, std::thread::hardware_concurrency()))
+        : queues_(n_threads)
+    {
+        workers_.reserve(n_threads);
+        for (auto idx : flux::iota(0uz, queues_.size())) {
+            workers_.emplace_back(
+                [this, idx](std::stop_token st) { run(st, idx); });
+        }
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    auto operator=(thread_pool const&) -> thread_pool& = delete;
+
+    static auto global() -> thread_pool&
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    auto size() const -> std::size_t { return queues_.size(); }
+
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>>
+    {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        auto task
+            = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto fut = task->get_future();
+        push([task] { (*task)(); });
+        return fut;
+    }
+
+    // Waits for `fut`, running queued tasks in the meantime so that it is
+    // safe to call from inside a task
+    template <typename T>
+    auto wait(std::future<T>& fut) -> T
+    {
+        wait_ready(fut);
+        return fut.get();
+    }
+
+    // Waits for all of `futs` without getting their results. Tasks usually
+    // refer to their caller's locals, so if one of them throws, the caller
+    // must wait for all the rest before rethrowing.
+    template <typename T>
+    void wait_all(std::span<std::future<T>> futs)
+    {
+        for (auto const& fut : futs) { wait_ready(fut); }
+    }
+
+private:
+    template <typename T>
+    void wait_ready(std::future<T> const& fut)
+    {
+        auto const home = current_worker().pool == this
+            ? current_worker().index
+            : 0;
+        while (fut.wait_for(std::chrono::seconds(0))
+               != std::future_status::ready) {
+            if (auto task = try_pop(home)) {
+                task();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    struct worker_id {
+        thread_pool const* pool = nullptr;
+        std::size_t index = 0;
+    };
+
+    struct task_queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static auto current_worker() -> worker_id&
+    {
+        thread_local worker_id id;
+        return id;
+    }
+
+    void push(std::function<void()> task)
+    {
+        auto const idx = current_worker().pool == this
+            ? current_worker().index
+            : next_queue_.fetch_add(1) % queues_.size();
+        {
+            std::scoped_lock lock(queues_[idx].mutex);
+            queues_[idx].tasks.push_back(std::move(task));
+        }
+        {
+            std::scoped_lock lock(sleep_mutex_);
+            ++pending_;
+        }
+        wakeup_.notify_one();
+    }
+
+    auto try_pop(std::size_t home) -> std::function<void()>
+    {
+        for (auto i : flux::iota(0uz, queues_.size())) {
+            auto& queue = queues_[(home + i) % queues_.size()];
+            std::scoped_lock lock(queue.mutex);
+            if (queue.tasks.empty()) { continue; }
+
+            std::function<void()> task;
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --pending_;
+            return task;
+        }
+        return {};
+    }
+
+    void run(std::stop_token st, std::size_t idx)
+    {
+        current_worker() = {.pool = this, .index = idx};
+        while (!st.stop_requested()) {
+            if (auto task = try_pop(idx)) {
+                task();
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            wakeup_.wait(lock, st, [this] { return pending_ > 0; });
+        }
+    }
+
+    std::vector<task_queue> queues_;
+    std::atomic<std::size_t> next_queue_ = 0;
+    std::atomic<std::size_t> pending_ = 0;
+    std::mutex sleep_mutex_;
+    std::condition_variable_any wakeup_;
+    // Declared last, so the workers are joined before anything else goes
+    std::vector<std::jthread> workers_;
+};
+
+// Calls f(i) for every i in [0, n), split into chunks across the global pool
+export template <typename F>
+void parallel_for(std::size_t n, F&& f)
+{
+    auto& pool = thread_pool::global();
+    auto const n_chunks = std::min(n, 4 * pool.size());
+    if (n_chunks <= 1) {
+        for (auto i : flux::iota(0uz, n)) { std::invoke(f, i); }
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(n_chunks);
+    for (auto c : flux::iota(0uz, n_chunks)) {
+        futures.push_back(pool.submit([&f, lo = n * c / n_chunks,
+                                       hi = n * (c + 1) / n_chunks] {
+            for (auto i : flux::iota(lo, hi)) { std::invoke(f, i); }
+        }));
+    }
+    pool.wait_all(std::span(futures));
+    for (auto& fut : futures) { fut.get(); }
+}
+
+namespace detail {
+
+// Splits `seq` into chunks of roughly equal length, reduces each chunk with
+// `op` on the global pool, and then folds the partial results in order.
+// Finding the chunk boundaries is O(1) per chunk for random-access sequences
+// and a walk over the cursors otherwise, so any expensive work should be in
+// the elements (e.g. a map) rather than in the traversal (e.g. a filter).
+template <flux::multipass_sequence Seq, typename T, typename Op>
+auto parallel_fold(Seq& seq, T init, Op op) -> T
+{
+    using cursor_t = flux::cursor_t<Seq>;
+
+    auto& pool = thread_pool::global();
+    auto const n = static_cast<std::size_t>(flux::count(seq));
+    auto const n_chunks = std::min(n, 4 * pool.size());
+    if (n_chunks == 0) { return init; }
+
+    std::vector<cursor_t> bounds{flux::first(seq)};
+    for (auto c : flux::iota(0uz, n_chunks)) {
+        auto const len = n * (c + 1) / n_chunks - n * c / n_chunks;
+        bounds.push_back(flux::next(seq, bounds.back(), flux::distance_t(len)));
+    }
+
+    std::vector<std::future<T>> futures;
+    futures.reserve(n_chunks);
+    for (auto c : flux::iota(0uz, n_chunks)) {
+        futures.push_back(
+            pool.submit([&seq, &op, from = bounds[c], to = bounds[c + 1]] {
+                T acc{};
+                for (auto cur = from; cur != to; flux::inc(seq, cur)) {
+                    acc = op(std::move(acc), flux::read_at(seq, cur));
+                }
+                return acc;
+            }));
+    }
+
+    pool.wait_all(std::span(futures));
+    for (auto& fut : futures) { init = op(std::move(init), fut.get()); }
+    return init;
+}
+
+} // namespace detail
+
+// Drop-in parallel versions of flux::sum(), flux::count_if() and flux::max().
+// During constant evaluation they fall back to the serial algorithms.
+export constexpr auto parallel_sum =
+    []<flux::multipass_sequence Seq>(Seq&& seq) static -> flux::value_t<Seq> {
+    if consteval {
+        return flux::sum(seq);
+    } else {
+        return detail::parallel_fold(seq, flux::value_t<Seq>{}, std::plus{});
+    }
+};
+
+export constexpr auto parallel_count_if =
+    []<flux::multipass_sequence Seq, typename Pred>(Seq&& seq,
+                                                     Pred pred) static
+    -> flux::distance_t {
+    if consteval {
+        return flux::count_if(seq, pred);
+    } else {
+        auto mapped = flux::map(flux::ref(seq), [&pred](auto&& elem) {
+            return flux::distance_t(std::invoke(pred, elem) ? 1 : 0);
+        });
+        return detail::parallel_fold(mapped, flux::distance_t{0}, std::plus{});
+    }
+};
+
+export constexpr auto parallel_max = []<flux::multipass_sequence Seq>(
+                                         Seq&& seq) static
+    -> std::optional<flux::value_t<Seq>> {
+    if consteval {
+        return flux::max(seq);
+    } else {
+        using T = std::optional<flux::value_t<Seq>>;
+        auto mapped = flux::map(flux::ref(seq),
+                                [](auto&& elem) -> T { return elem; });
+        return detail::parallel_fold(mapped, T{}, [](T lhs, T rhs) {
+            return !lhs || (rhs && *rhs >= *lhs) ? rhs : lhs;
+        });
+    }
+};
+
+// The offsets of every newline in a buffer, and optionally of every
+// occurrence of one other delimiter, found in a single pass. With AVX2 this
+// compares 64 bytes at a time and turns the bitmasks into offsets; otherwise
+// (or during constant evaluation) it's a byte-by-byte loop. `width` is the
+// length of the first line and `height` the number of newlines, which is how
+// the grid days measure their inputs.
+export struct structural_index {
+    arena_vector<std::size_t> newlines;
+    arena_vector<std::size_t> delimiters;
+    std::size_t width = 0;
+    std::size_t height = 0;
+
+    // The i'th line of `input`, without its newline
+    constexpr auto line(std::string_view input, std::size_t i) const
+        -> std::string_view
+    {
+        auto const start = i == 0 ? 0 : newlines[i - 1] + 1;
+        auto const end = i < newlines.size() ? newlines[i] : input.size();
+        return input.substr(start, end - start);
+    }
+};
+
+namespace detail {
+
+constexpr void index_scalar(std::string_view input, std::size_t from,
+                            std::optional<char> delim, structural_index& idx)
+{
+    for (auto i : flux::iota(from, input.size())) {
+        if (input[i] == '\n') {
+            idx.newlines.push_back(i);
+        } else if (input[i] == delim) {
+            idx.delimiters.push_back(i);
+        }
+    }
+}
+
+#ifdef AOC_HAVE_AVX2_KERNELS
+
+// Appends base + the position of each set bit in mask
+inline void append_bits(arena_vector<std::size_t>& out, std::uint64_t mask,
+                        std::size_t base)
+{
+    auto n = out.size();
+    out.resize(n + std::popcount(mask));
+    for (; mask != 0; mask &= mask - 1) {
+        out[n++] = base + std::countr_zero(mask);
+    }
+}
+
+[[gnu::target("avx2")]] inline auto eq_mask(char const* p, __m256i c)
+    -> std::uint64_t
+{
+    auto const lo = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+    auto const hi
+        = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + 32));
+    auto const lo_bits
+        = std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c)));
+    auto const hi_bits
+        = std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)));
+    return lo_bits | (std::uint64_t{hi_bits} << 32);
+}
+
+// Indexes whole 64-byte blocks, returning where the scalar loop should
+// pick up
+[[gnu::target("avx2")]] inline auto
+index_avx2(std::string_view input, std::optional<char> delim,
+           structural_index& idx) -> std::size_t
+{
+    auto const newline = _mm256_set1_epi8('\n');
+    auto const delimiter = _mm256_set1_epi8(delim.value_or('\n'));
+
+    std::size_t i = 0;
+    for (; i + 64 <= input.size(); i += 64) {
+        append_bits(idx.newlines, eq_mask(input.data() + i, newline), i);
+        if (delim) {
+            append_bits(idx.delimiters, eq_mask(input.data() + i, delimiter),
+                        i);
+        }
+    }
+    return i;
+}
+
+inline auto have_avx2() -> bool
+{
+    static bool const result = __builtin_cpu_supports("avx2");
+    return result;
+}
+
+#endif
+
+} // namespace detail
+
+export constexpr auto index_structure =
+    [](std::string_view input, std::optional<char> delimiter = std::nullopt,
+       arena_allocator<> alloc = {}) static -> structural_index {
+    structural_index idx{.newlines = arena_vector<std::size_t>(alloc),
+                         .delimiters = arena_vector<std::size_t>(alloc)};
+
+    std::size_t done = 0;
+    if !consteval {
+#ifdef AOC_HAVE_AVX2_KERNELS
+        if (detail::have_avx2()) {
+            done = detail::index_avx2(input, delimiter, idx);
+        }
+#endif
+    }
+    detail::index_scalar(input, done, delimiter, idx);
+
+    idx.height = idx.newlines.size();
+    idx.width = idx.newlines.empty() ? input.size() : idx.newlines.front();
+    return idx;
+};
+
+static_assert([] {
+    constexpr std::string_view text = "ab,c\nde\n,";
+    auto const idx = index_structure(text, ',');
+    return idx.width == 4 && idx.height == 2 && idx.line(text, 1) == "de"
+        && flux::equal(idx.delimiters, std::array{2uz, 8uz});
+}());
+
+// Parses every non-blank line of `input` with `read`, which is handed a
+// scanner positioned at the start of a line and must consume exactly that
+// line. Large inputs are split into chunks at newlines, which are parsed
+// into local vectors on the global pool and then concatenated in order, so
+// `read` must be safe to call concurrently. During constant evaluation, or
+// for inputs too small to be worth it, it's a plain loop.
+export constexpr auto parse_lines =
+    []<typename Read>(std::string_view input, Read read,
+                      arena_allocator<> alloc = {}) static {
+    using T = std::remove_cvref_t<std::invoke_result_t<Read&, scanner&>>;
+
+    auto parse_chunk = [&read](std::string_view chunk, auto& into) {
+        for (scanner sc(chunk); !sc.skip_whitespace().at_end();) {
+            into.push_back(std::invoke(read, sc));
+        }
+    };
+
+    arena_vector<T> out(alloc);
+
+    if consteval {
+        parse_chunk(input, out);
+        return out;
+    } else {
+        auto& pool = thread_pool::global();
+        auto const n_chunks = input.size() < (1 << 20) ? 1 : 4 * pool.size();
+        if (n_chunks == 1) {
+            parse_chunk(input, out);
+            return out;
+        }
+
+        // Each boundary is moved on to just after the next newline
+        std::vector<std::size_t> bounds{0};
+        for (auto c : flux::iota(1uz, n_chunks)) {
+            auto const pos = input.find(
+                '\n', std::max(input.size() * c / n_chunks, bounds.back()));
+            bounds.push_back(pos == input.npos ? input.size() : pos + 1);
+        }
+        bounds.push_back(input.size());
+
+        std::vector<std::future<std::vector<T>>> futures;
+        futures.reserve(n_chunks);
+        for (auto c : flux::iota(0uz, n_chunks)) {
+            futures.push_back(pool.submit(
+                [&, from = bounds[c], to = bounds[c + 1]] {
+                    std::vector<T> local;
+                    parse_chunk(input.substr(from, to - from), local);
+                    return local;
+                }));
+        }
+
+        pool.wait_all(std::span(futures));
+        std::vector<std::vector<T>> parts;
+        parts.reserve(n_chunks);
+        for (auto& fut : futures) { parts.push_back(fut.get()); }
+
+        out.reserve(flux::sum(flux::map(
+            parts, [](std::vector<T> const& part) { return part.size(); })));
+        for (auto& part : parts) {
+            out.insert(out.end(), std::make_move_iterator(part.begin()),
+                       std::make_move_iterator(part.end()));
+        }
+        return out;
+    }
+};
+
+namespace detail {
+
+constinit std::atomic<std::uint64_t> allocation_count{0};
+constinit std::atomic<std::uint64_t> allocated_bytes{0};
+constinit std::atomic<std::uint64_t> live_bytes{0};
+constinit std::atomic<std::uint64_t> peak_live_bytes{0};
+
+inline void raise_to(std::atomic<std::uint64_t>& a, std::uint64_t value)
+{
+    auto cur = a.load(std::memory_order_relaxed);
+    while (value > cur
+           && !a.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace detail
+
+// Allocation accounting. The counts are fed by the replacement global
+// operator new and delete in alloc_hooks.cpp, which are only built when the
+// project is configured with -DAOC_TRACK_ALLOCATIONS=ON; otherwise they all
+// stay at zero.
+export namespace memory {
+
+struct usage {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t live = 0;
+    std::uint64_t peak = 0;
+};
+
+void record_allocation(std::size_t bytes) noexcept
+{
+    detail::allocation_count.fetch_add(1, std::memory_order_relaxed);
+    detail::allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    auto const live
+        = detail::live_bytes.fetch_add(bytes, std::memory_order_relaxed)
+        + bytes;
+    detail::raise_to(detail::peak_live_bytes, live);
+}
+
+void record_deallocation(std::size_t bytes) noexcept
+{
+    detail::live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+auto current() noexcept -> usage
+{
+    return {.allocations = detail::allocation_count.load(),
+            .bytes = detail::allocated_bytes.load(),
+            .live = detail::live_bytes.load(),
+            .peak = detail::peak_live_bytes.load()};
+}
+
+// Peak measurements nest: begin_peak() restarts the high-water mark from the
+// current live bytes and returns the enclosing measurement's mark, which must
+// be handed back to the matching end_peak(). That returns the peak in
+// between. Measurements on different threads which overlap in time will see
+// each other's allocations.
+auto begin_peak() noexcept -> std::uint64_t
+{
+    return detail::peak_live_bytes.exchange(detail::live_bytes.load());
+}
+
+auto end_peak(std::uint64_t outer) noexcept -> std::uint64_t
+{
+    auto const peak = detail::peak_live_bytes.load();
+    detail::raise_to(detail::peak_live_bytes, outer);
+    return peak;
+}
+
+// The peak resident set size of the process in bytes, if the OS tells us
+auto peak_rss() -> std::optional<std::uint64_t>
+{
+#ifdef AOC_HAVE_GETRUSAGE
+    rusage ru{};
+    if (::getrusage(RUSAGE_SELF, &ru) != 0) { return std::nullopt; }
+#    ifdef __APPLE__
+    return static_cast<std::uint64_t>(ru.ru_maxrss);
+#    else
+    return static_cast<std::uint64_t>(ru.ru_maxrss) * 1024;
+#    endif
+#else
+    return std::nullopt;
+#endif
+}
+
+} // namespace memory
+
+namespace detail {
+
+inline auto read_tsc() -> std::uint64_t
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Per-thread hardware counters (instructions, cache misses, branch misses),
+// read as a single group. Opening them fails without the right permissions,
+// in which case we just go without.
+class perf_counters {
+public:
+    using values = std::array<std::uint64_t, 3>;
+
+#ifdef AOC_HAVE_PERF_EVENTS
+    perf_counters()
+    {
+        fds_[0] = open(PERF_COUNT_HW_INSTRUCTIONS, -1);
+        fds_[1] = open(PERF_COUNT_HW_CACHE_MISSES, fds_[0]);
+        fds_[2] = open(PERF_COUNT_HW_BRANCH_MISSES, fds_[0]);
+        if (flux::any(fds_, flux::pred::lt(0))) {
+            close_all();
+            return;
+        }
+        ::ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    ~perf_counters() { close_all(); }
+
+    auto read() -> std::optional<values>
+    {
+        struct {
+            std::uint64_t count;
+            values vals;
+        } data;
+        if (fds_[0] < 0
+            || ::read(fds_[0], &data, sizeof(data))
+                != static_cast<ssize_t>(sizeof(data))) {
+            return std::nullopt;
+        }
+        return data.vals;
+    }
+
+private:
+    static auto open(std::uint64_t config, int group) -> int
+    {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(
+            ::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+
+    void close_all()
+    {
+        for (int& fd : fds_) {
+            if (fd >= 0) { ::close(fd); }
+            fd = -1;
+        }
+    }
+
+    std::array<int, 3> fds_{-1, -1, -1};
+#else
+    auto read() -> std::optional<values> { return std::nullopt; }
+#endif
+
+public:
+    static auto for_this_thread() -> perf_counters&
+    {
+        thread_local perf_counters counters;
+        return counters;
+    }
+};
+
+struct zone_stats {
+    std::string name;
+    std::atomic<std::uint64_t> calls = 0;
+    std::atomic<std::uint64_t> nanoseconds = 0;
+    std::atomic<std::uint64_t> cycles = 0;
+    std::atomic<bool> have_counters = true;
+    std::array<std::atomic<std::uint64_t>, 3> counters{};
+    std::atomic<std::uint64_t> allocations = 0;
+    std::atomic<std::uint64_t> allocated_bytes = 0;
+    std::atomic<std::uint64_t> peak_growth = 0;
+};
+
+// Probes can be hit by every thread for every element, so their counts are
+// spread over per-thread shards to keep them off each other's cache lines
+struct probe_stats {
+    struct alignas(64) shard {
+        std::atomic<std::uint64_t> elements = 0;
+        std::atomic<std::uint64_t> passed = 0;
+        std::atomic<std::uint64_t> cycles = 0;
+    };
+
+    std::string name;
+    std::atomic<bool> is_predicate = false;
+    std::atomic<bool> timed = false;
+    std::array<shard, 16> shards;
+
+    auto this_thread_shard() -> shard&
+    {
+        static std::atomic<unsigned> next_index = 0;
+        thread_local unsigned const index = next_index++ % shards.size();
+        return shards[index];
+    }
+
+    auto total(std::atomic<std::uint64_t> shard::* member) const
+        -> std::uint64_t
+    {
+        return flux::sum(flux::map(shards, [&](shard const& sh) {
+            return (sh.*member).load();
+        }));
+    }
+};
+
+// Owns the statistics for every zone, and prints them when the program
+// exits. Only active if the AOC_PROFILE environment variable is set.
+class profiler {
+public:
+    static auto instance() -> profiler&
+    {
+        static profiler prof;
+        return prof;
+    }
+
+    auto enabled() const -> bool { return enabled_; }
+
+    // Stats is either zone_stats or probe_stats
+    template <typename Stats>
+    auto stats_for(std::string_view name) -> Stats&
+    {
+        // Names are almost always string literals, so each thread keeps a
+        // lock-free cache keyed on the address of the name
+        thread_local hash_map<char const*, Stats*> cache;
+        if (auto iter = cache.find(name.data()); iter != cache.end()) {
+            return *iter->second;
+        }
+
+        std::scoped_lock lock(mutex_);
+        auto& all = [this]() -> std::deque<Stats>& {
+            if constexpr (std::same_as<Stats, zone_stats>) {
+                return zones_;
+            } else {
+                return probes_;
+            }
+        }();
+        auto iter = std::ranges::find(all, name, &Stats::name);
+        auto& stats = iter != all.end() ? *iter : all.emplace_back();
+        if (stats.name.empty()) { stats.name = name; }
+        cache[name.data()] = &stats;
+        return stats;
+    }
+
+    profiler(profiler const&) = delete;
+    auto operator=(profiler const&) -> profiler& = delete;
+
+    ~profiler()
+    {
+        if (zones_.empty() && probes_.empty()) { return; }
+
+        // Allocation columns only mean anything with the hooks built in
+        auto const mem = memory::current();
+        bool const tracking = mem.allocations > 0;
+
+        if (!zones_.empty()) { print_zones(tracking); }
+        if (!probes_.empty()) { print_probes(); }
+
+        if (tracking) {
+            std::println(std::cerr,
+                         "total: {} allocations, {:.2f} MiB allocated, "
+                         "{:.2f} MiB peak live",
+                         mem.allocations, mib(mem.bytes), mib(mem.peak));
+        }
+        if (auto rss = memory::peak_rss()) {
+            std::println(std::cerr, "peak RSS: {:.2f} MiB", mib(*rss));
+        }
+    }
+
+private:
+    profiler() : enabled_(std::getenv("AOC_PROFILE") != nullptr) {}
+
+    static auto mib(std::uint64_t bytes) -> double
+    {
+        return bytes / 1048576.0;
+    }
+
+    void print_zones(bool tracking) const
+    {
+        std::vector<zone_stats const*> sorted;
+        for (zone_stats const& z : zones_) { sorted.push_back(&z); }
+        std::ranges::sort(sorted, std::greater{}, [](zone_stats const* z) {
+            return z->nanoseconds.load();
+        });
+
+        std::print(std::cerr, "{:<32}{:>10}{:>12}{:>16}{:>16}{:>14}{:>14}",
+                   "zone", "calls", "time (ms)", "cycles", "instructions",
+                   "cache misses", "branch misses");
+        if (tracking) {
+            std::print(std::cerr, "{:>12}{:>12}{:>12}", "allocs",
+                       "alloc MiB", "peak MiB");
+        }
+        std::println(std::cerr);
+
+        for (zone_stats const* z : sorted) {
+            auto counter = [&](std::size_t i) -> std::string {
+                return z->have_counters
+                    ? std::to_string(z->counters[i].load())
+                    : "n/a";
+            };
+            std::print(std::cerr,
+                       "{:<32}{:>10}{:>12.3f}{:>16}{:>16}{:>14}{:>14}",
+                       z->name, z->calls.load(), z->nanoseconds / 1e6,
+                       z->cycles.load(), counter(0), counter(1), counter(2));
+            if (tracking) {
+                std::print(std::cerr, "{:>12}{:>12.2f}{:>12.2f}",
+                           z->allocations.load(), mib(z->allocated_bytes),
+                           mib(z->peak_growth));
+            }
+            std::println(std::cerr);
+        }
+    }
+
+    void print_probes() const
+    {
+        std::println(std::cerr, "{:<32}{:>16}{:>16}{:>16}{:>14}", "probe",
+                     "elements", "passed", "rejected", "cycles/elem");
+        for (probe_stats const& p : probes_) {
+            auto const elements = p.total(&probe_stats::shard::elements);
+            auto const passed = p.total(&probe_stats::shard::passed);
+            auto const na = std::string("n/a");
+            std::println(
+                std::cerr, "{:<32}{:>16}{:>16}{:>16}{:>14}", p.name, elements,
+                p.is_predicate ? std::to_string(passed) : na,
+                p.is_predicate ? std::to_string(elements - passed) : na,
+                p.timed && elements > 0
+                    ? std::format("{:.1f}",
+                                  double(p.total(&probe_stats::shard::cycles))
+                                      / double(elements))
+                    : na);
+        }
+    }
+
+    bool enabled_;
+    std::mutex mutex_;
+    std::deque<zone_stats> zones_;
+    std::deque<probe_stats> probes_;
+};
+
+} // namespace detail
+
+// A named RAII profiling zone. When the AOC_PROFILE environment variable is
+// set, every zone with the same name adds its call count, wall-clock time,
+// TSC cycles and (where the kernel allows it) hardware counters to a report
+// printed to stderr at exit. With AOC_TRACK_ALLOCATIONS, it also counts the
+// allocations made in the zone and the most its live bytes grew to above
+// what they were on entry. Times and allocations are inclusive of nested
+// zones. Zones do nothing during constant evaluation, so they can go in
+// constexpr solvers.
+export class zone {
+public:
+    constexpr explicit zone(std::string_view name)
+    {
+        if !consteval {
+            auto& prof = detail::profiler::instance();
+            if (!prof.enabled()) { return; }
+            stats_ = &prof.stats_for<detail::zone_stats>(name);
+            counters_ = detail::perf_counters::for_this_thread().read();
+            start_memory_ = memory::current();
+            outer_peak_ = memory::begin_peak();
+            start_cycles_ = detail::read_tsc();
+            start_time_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    zone(zone const&) = delete;
+    auto operator=(zone const&) -> zone& = delete;
+
+    constexpr ~zone()
+    {
+        if !consteval {
+            if (stats_ == nullptr) { return; }
+            auto const elapsed = std::chrono::steady_clock::now() - start_time_;
+            auto const cycles = detail::read_tsc() - start_cycles_;
+            auto const counters
+                = detail::perf_counters::for_this_thread().read();
+            auto const peak = memory::end_peak(outer_peak_);
+            auto const mem = memory::current();
+
+            auto& s = *stats_;
+            s.calls.fetch_add(1, std::memory_order_relaxed);
+            s.nanoseconds.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                    .count(),
+                std::memory_order_relaxed);
+            s.cycles.fetch_add(cycles, std::memory_order_relaxed);
+            if (counters_ && counters) {
+                for (auto i : flux::iota(0uz, 3uz)) {
+                    s.counters[i].fetch_add((*counters)[i] - (*counters_)[i],
+                                            std::memory_order_relaxed);
+                }
+            } else {
+                s.have_counters = false;
+            }
+            s.allocations.fetch_add(mem.allocations
+                                        - start_memory_.allocations,
+                                    std::memory_order_relaxed);
+            s.allocated_bytes.fetch_add(mem.bytes - start_memory_.bytes,
+                                        std::memory_order_relaxed);
+            detail::raise_to(s.peak_growth,
+                             std::max(peak, start_memory_.live)
+                                 - start_memory_.live);
+        }
+    }
+
+private:
+    detail::zone_stats* stats_ = nullptr;
+    std::optional<detail::perf_counters::values> counters_;
+    memory::usage start_memory_{};
+    std::uint64_t outer_peak_ = 0;
+    std::uint64_t start_cycles_ = 0;
+    std::chrono::steady_clock::time_point start_time_{};
+};
+
+namespace detail {
+
+// A cache file is a header, a table of sections, and then each section's
+// elements, starting on a 64-byte boundary. Files are only ever read back
+// on the machine that wrote them, so everything is in native byte order.
+struct cache_header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t n_sections;
+    std::uint64_t input_hash;
+    std::uint64_t input_size;
+};
+
+struct cache_section {
+    std::uint64_t offset;
+    std::uint64_t count;
+    std::uint64_t elem_size;
+};
+
+inline constexpr std::array<char, 8> cache_magic{'A', 'O', 'C', 'C',
+                                                 'A', 'C', 'H', 'E'};
+inline constexpr std::uint32_t cache_version = 1;
+
+inline auto cache_path(std::string_view tag, std::uint64_t hash)
+    -> std::optional<std::filesystem::path>
+{
+    char const* dir = std::getenv("AOC_CACHE_DIR");
+    if (dir == nullptr || *dir == '\0') { return std::nullopt; }
+    return std::filesystem::path(dir)
+        / std::format("{}-{:016x}.bin", tag, hash);
+}
+
+inline auto hash_input(std::string_view text) -> std::uint64_t
+{
+    return ankerl::unordered_dense::hash<std::string_view>{}(text);
+}
+
+} // namespace detail
+
+// A parsed-input cache file, mapped read-only (or, without mmap, read into
+// memory). Sections are handed out as spans straight into the mapping.
+export class cache_file {
+public:
+    cache_file(cache_file&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          buffer_(std::move(other.buffer_))
+    {}
+
+    auto operator=(cache_file&&) -> cache_file& = delete;
+
+    ~cache_file()
+    {
+#ifdef AOC_HAVE_MMAP
+        if (data_ != nullptr && buffer_.empty()) {
+            ::munmap(const_cast<std::byte*>(data_), size_);
+        }
+#endif
+    }
+
+    auto n_sections() const -> std::size_t { return header().n_sections; }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    auto section(std::size_t i) const -> std::span<T const>
+    {
+        if (i >= n_sections()) {
+            throw std::out_of_range("cache: no such section");
+        }
+        auto const& s = sections()[i];
+        if (s.elem_size != sizeof(T)) {
+            throw std::runtime_error("cache: section has the wrong type");
+        }
+        return {reinterpret_cast<T const*>(data_ + s.offset), s.count};
+    }
+
+    // Returns nothing if caching is off (AOC_CACHE_DIR is unset), or there
+    // is no valid cache file for this input
+    static auto load(std::string_view tag, std::string_view input)
+        -> std::optional<cache_file>
+    {
+        auto const hash = detail::hash_input(input);
+        auto const path = detail::cache_path(tag, hash);
+        if (!path) { return std::nullopt; }
+
+        auto file = open(*path);
+        if (!file || !file->valid(hash, input.size())) { return std::nullopt; }
+        return file;
+    }
+
+private:
+    cache_file(std::byte const* data, std::size_t size,
+               std::vector<std::byte> buffer = {})
+        : data_(data),
+          size_(size),
+          buffer_(std::move(buffer))
+    {}
+
+    static auto open(std::filesystem::path const& path)
+        -> std::optional<cache_file>
+    {
+#ifdef AOC_HAVE_MMAP
+        int const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) { return std::nullopt; }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0
+            || std::size_t(st.st_size) < sizeof(detail::cache_header)) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        auto const size = std::size_t(st.st_size);
+        void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) { return std::nullopt; }
+        return cache_file(static_cast<std::byte const*>(ptr), size);
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) { return std::nullopt; }
+        std::vector<std::byte> buffer(std::filesystem::file_size(path));
+        file.read(reinterpret_cast<char*>(buffer.data()),
+                  static_cast<std::streamsize>(buffer.size()));
+        auto const* data = buffer.data();
+        auto const size = buffer.size();
+        return cache_file(data, size, std::move(buffer));
+#endif
+    }
+
+    auto header() const -> detail::cache_header const&
+    {
+        return *reinterpret_cast<detail::cache_header const*>(data_);
+    }
+
+    auto sections() const -> std::span<detail::cache_section const>
+    {
+        return {reinterpret_cast<detail::cache_section const*>(
+                    data_ + sizeof(detail::cache_header)),
+                header().n_sections};
+    }
+
+    auto valid(std::uint64_t hash, std::size_t input_size) const -> bool
+    {
+        if (size_ < sizeof(detail::cache_header)) { return false; }
+        auto const& h = header();
+        if (h.magic != detail::cache_magic
+            || h.version != detail::cache_version || h.input_hash != hash
+            || h.input_size != input_size
+            || h.n_sections
+                > (size_ - sizeof(h)) / sizeof(detail::cache_section)) {
+            return false;
+        }
+        return flux::all(sections(), [&](detail::cache_section const& s) {
+            return s.offset % 64 == 0 && s.offset <= size_
+                && s.elem_size != 0
+                && s.count <= (size_ - s.offset) / s.elem_size;
+        });
+    }
+
+    std::byte const* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::vector<std::byte> buffer_;
+};
+
+// Writes the given arrays as the cache file for `input`, if caching is on.
+// The file is written under a temporary name and then renamed into place,
+// so a reader never sees half of one. Failures are ignored: the cache is
+// only ever an optimisation.
+export template <typename... Ts>
+    requires(std::is_trivially_copyable_v<Ts> && ...)
+void cache_store(std::string_view tag, std::string_view input,
+                 std::span<Ts const>... sections)
+{
+    auto const hash = detail::hash_input(input);
+    auto const path = detail::cache_path(tag, hash);
+    if (!path) { return; }
+
+    auto const align = [](std::uint64_t n) { return (n + 63) / 64 * 64; };
+
+    detail::cache_header const header{.magic = detail::cache_magic,
+                                      .version = detail::cache_version,
+                                      .n_sections = sizeof...(Ts),
+                                      .input_hash = hash,
+                                      .input_size = input.size()};
+
+    std::vector<detail::cache_section> table;
+    std::uint64_t offset = sizeof(header)
+        + sizeof...(Ts) * sizeof(detail::cache_section);
+    (
+        [&] {
+            offset = align(offset);
+            table.push_back({offset, sections.size(), sizeof(Ts)});
+            offset += sections.size_bytes();
+        }(),
+        ...);
+
+    std::error_code ec;
+    std::filesystem::create_directories(path->parent_path(), ec);
+    // Unique to this process and thread, so concurrent writers never share a
+    // temporary file
+    auto tmp = *path;
+    auto const thread
+        = std::hash<std::thread::id>{}(std::this_thread::get_id());
+#ifdef AOC_HAVE_MMAP
+    auto const process = static_cast<std::uint64_t>(::getpid());
+#else
+    auto const process = std::uint64_t{std::random_device{}()};
+#endif
+    tmp += std::format(".{:x}.{:x}.tmp", process, thread);
+
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        auto write = [&](void const* data, std::size_t n) {
+            out.write(static_cast<char const*>(data),
+                      static_cast<std::streamsize>(n));
+        };
+        auto pad_to = [&](std::uint64_t pos) {
+            static constexpr std::array<char, 64> zeros{};
+            write(zeros.data(), pos - static_cast<std::uint64_t>(out.tellp()));
+        };
+
+        write(&header, sizeof(header));
+        write(table.data(), table.size() * sizeof(table[0]));
+        std::size_t i = 0;
+        (
+            [&] {
+                pad_to(table[i++].offset);
+                write(sections.data(), sections.size_bytes());
+            }(),
+            ...);
+        if (!out) {
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmp, *path, ec);
+}
+
+namespace detail {
+
+template <typename Parse>
+auto parse_into(Parse& parse, std::string_view text, arena& mem)
+{
+    if constexpr (std::invocable<Parse&, std::string_view, arena&>) {
+        return std::invoke(parse, text, mem);
+    } else {
+        return std::invoke(parse, text);
+    }
+}
+
+} // namespace detail
+
+// Keeps a day resident, reading requests from stdin one per line. Every
+// day's main calls this when run as `decNN --serve`.
+//
+//   file <path>   solve the input in the file at <path>
+//   data <n>      solve the <n> bytes of input following the newline
+//   quit
+//
+// Blank lines between requests, such as a newline after some data, are
+// skipped. Each response is the string returned by `answer`, then a line
+// reading `done parsed|cached <time>`, or a single `error <message>` line.
+// The most recent `capacity` parsed inputs are kept, keyed by a hash of their
+// text, so that re-solving an unchanged input skips parsing. Each one owns
+// its text (so it can be parsed into string_views) and its own arena.
+// `parse` is called as parse(text, arena) if it can be, and otherwise as
+// parse(text).
+export template <typename Parse, typename Answer>
+auto serve(Parse parse, Answer answer, std::size_t capacity = 16) -> int
+{
+    using parsed_t = decltype(detail::parse_into(
+        parse, std::string_view{}, std::declval<arena&>()));
+
+    struct entry {
+        std::string text;
+        arena mem;
+        std::optional<parsed_t> parsed;
+    };
+
+    hash_map<std::uint64_t, std::unique_ptr<entry>> cache;
+    std::deque<std::uint64_t> order;
+    // Reused between requests, so reading an input rarely allocates
+    std::string line;
+    std::string text;
+
+    while (std::getline(std::cin, line) && line != "quit") {
+        if (line.empty() || line == "\r") { continue; }
+
+        auto const space = std::min(line.find(' '), line.size());
+        auto const cmd = std::string_view(line).substr(0, space);
+        auto const arg = std::string(
+            std::string_view(line).substr(std::min(space + 1, line.size())));
+
+        try {
+            timer t;
+
+            if (cmd == "file") {
+                std::ifstream file(arg, std::ios::binary);
+                if (!file) { throw std::runtime_error("cannot open " + arg); }
+                text.assign(std::istreambuf_iterator<char>(file), {});
+            } else if (cmd == "data") {
+                text.resize(aoc::parse<std::size_t>(arg));
+                std::cin.read(text.data(),
+                              static_cast<std::streamsize>(text.size()));
+                if (std::cmp_not_equal(std::cin.gcount(), text.size())) {
+                    throw std::runtime_error("input ended early");
+                }
+            } else {
+                throw std::runtime_error("unknown command " + line);
+            }
+
+            auto const key = ankerl::unordered_dense::hash<std::string_view>{}(
+                std::string_view(text));
+            auto iter = cache.find(key);
+            bool const hit = iter != cache.end() && iter->second->text == text;
+
+            if (!hit) {
+                // On a hash collision, the newer input wins
+                if (iter != cache.end()) {
+                    cache.erase(iter);
+                    std::erase(order, key);
+                }
+                if (cache.size() >= capacity) {
+                    cache.erase(order.front());
+                    order.pop_front();
+                }
+                auto e = std::make_unique<entry>();
+                e->text = text;
+                e->parsed.emplace(detail::parse_into(parse, e->text, e->mem));
+                iter = cache.emplace(key, std::move(e)).first;
+                order.push_back(key);
+            }
+
+            std::println("{}", answer(*iter->second->parsed));
+            std::println("done {} {}", hit ? "cached" : "parsed",
+                         t.elapsed());
+        } catch (std::exception const& ex) {
+            std::println("error {}", ex.what());
+        }
+        std::cout.flush();
+    }
+
+    return 0;
+}
+
+export enum class timing : bool { off, on };
+
+// A probe to put between the stages of a pipeline. aoc::counted(name) passes
+// elements through unchanged, counting them, so it can go in a map().
+// aoc::counted(name, fn) wraps a function instead, counting its calls and,
+// if it is a predicate, how many elements it passed; with timing::on it also
+// times each call in TSC cycles. Counts go into the AOC_PROFILE report. With
+// profiling off a probe costs one branch per element, and during constant
+// evaluation it does nothing at all.
+export template <typename F = std::identity>
+class counted {
+public:
+    constexpr explicit counted(std::string_view name, F fn = {},
+                               timing t = timing::off)
+        : fn_(std::move(fn))
+    {
+        if !consteval {
+            auto& prof = detail::profiler::instance();
+            if (!prof.enabled()) { return; }
+            stats_ = &prof.stats_for<detail::probe_stats>(name);
+            timed_ = t == timing::on;
+            if (timed_) { stats_->timed = true; }
+        }
+    }
+
+    template <typename T>
+        requires std::same_as<F, std::identity>
+    constexpr auto operator()(T&& elem) const -> T
+    {
+        if !consteval {
+            if (stats_ != nullptr) { record<false>(0, false); }
+        }
+        return std::forward<T>(elem);
+    }
+
+    template <typename... Args>
+        requires(!std::same_as<F, std::identity>)
+                && std::invocable<F const&, Args...>
+    constexpr auto operator()(Args&&... args) const -> decltype(auto)
+    {
+        using R = std::invoke_result_t<F const&, Args...>;
+        constexpr bool is_predicate
+            = std::same_as<std::remove_cvref_t<R>, bool>;
+
+        std::uint64_t start = 0;
+        if !consteval {
+            if (timed_) { start = detail::read_tsc(); }
+        }
+
+        decltype(auto) result = std::invoke(fn_, std::forward<Args>(args)...);
+
+        if !consteval {
+            if (stats_ != nullptr) {
+                if constexpr (is_predicate) {
+                    record<true>(start, result);
+                } else {
+                    record<false>(start, false);
+                }
+            }
+        }
+
+        if constexpr (std::is_reference_v<R>) {
+            return static_cast<R>(result);
+        } else {
+            return result;
+        }
+    }
+
+private:
+    template <bool IsPredicate>
+    void record(std::uint64_t start, bool passed) const
+    {
+        // Only ever written once, so the line stays shared between threads
+        auto& flag = stats_->is_predicate;
+        if (IsPredicate && !flag.load(std::memory_order_relaxed)) {
+            flag.store(true, std::memory_order_relaxed);
+        }
+        auto& shard = stats_->this_thread_shard();
+        shard.elements.fetch_add(1, std::memory_order_relaxed);
+        if (passed) { shard.passed.fetch_add(1, std::memory_order_relaxed); }
+        if (timed_) {
+            shard.cycles.fetch_add(detail::read_tsc() - start,
+                                   std::memory_order_relaxed);
+        }
+    }
+
+    F fn_;
+    detail::probe_stats* stats_ = nullptr;
+    bool timed_ = false;
+};
+
 export template <typename T>
 struct vec2_t {
     T x = T{};
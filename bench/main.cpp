@@ -0,0 +1,288 @@
+
+import aoc;
+
+// Paired versions of some of the hot flux pipelines from the solutions, each
+// next to the same computation written as plain loops. Each pair is run on
+// generated inputs and must give the same answer; the report shows how
+// long each one takes, and the `bench_code_size` target shows how much code
+// each one generates.
+//
+// The kernels are out-of-line functions with external linkage, so that they
+// are timed as a whole and show up under their own names in `nm`.
+
+using i64 = std::int64_t;
+using u64 = std::uint64_t;
+
+namespace kernels {
+
+// dec01 part 1: running position with flux::scan
+[[gnu::noinline]] auto dec01_flux(std::span<int const> offsets) -> i64
+{
+    return flux::ref(offsets).scan(std::plus{}, 50).count_if([](int i) {
+        return i % 100 == 0;
+    });
+}
+
+[[gnu::noinline]] auto dec01_loop(std::span<int const> offsets) -> i64
+{
+    i64 count = 0;
+    int pos = 50;
+    for (int offset : offsets) {
+        pos += offset;
+        count += pos % 100 == 0;
+    }
+    return count;
+}
+
+// dec04 part 1: accessible rolls, visiting cells with the
+// cartesian_product_map from grid2d::coordinates(). The loop version visits
+// them in the same (column-major) order, so only the iteration differs.
+struct grid2d {
+    std::string data;
+    int width;
+    int height;
+
+    auto operator[](aoc::vec2_t<int> c) const -> char
+    {
+        if (c.x < 0 || c.x >= width || c.y < 0 || c.y >= height) {
+            return '.';
+        } else {
+            return data[c.y * width + c.x];
+        }
+    }
+};
+
+auto accessible(grid2d const& grid, aoc::vec2_t<int> pos) -> bool
+{
+    constexpr std::array<aoc::vec2_t<int>, 8> neighbours = {
+        aoc::vec2_t<int>{-1, -1}, {0, -1}, {1, -1}, {-1, 0},
+        {1, 0},                   {-1, 1}, {0, 1},  {1, 1}};
+
+    return flux::map(neighbours, [&](aoc::vec2_t<int> n) {
+               return grid[pos + n];
+           }).count_eq('@') < 4;
+}
+
+[[gnu::noinline]] auto dec04_flux(grid2d const& grid) -> i64
+{
+    return flux::cartesian_product_map(
+               [](int x, int y) { return aoc::vec2_t<int>{x, y}; },
+               flux::iota(0, grid.width), flux::iota(0, grid.height))
+        .filter([&](aoc::vec2_t<int> pos) { return grid[pos] == '@'; })
+        .count_if([&](aoc::vec2_t<int> pos) { return accessible(grid, pos); });
+}
+
+[[gnu::noinline]] auto dec04_loop(grid2d const& grid) -> i64
+{
+    i64 count = 0;
+    for (int x = 0; x < grid.width; ++x) {
+        for (int y = 0; y < grid.height; ++y) {
+            aoc::vec2_t<int> const pos{x, y};
+            count += grid[pos] == '@' && accessible(grid, pos);
+        }
+    }
+    return count;
+}
+
+// dec06 part 2: problems are runs of columns found with chunk_by, and each
+// column of digits is read top to bottom
+using lines_t = std::vector<std::string>;
+
+[[gnu::noinline]] auto dec06_flux(lines_t const& input) -> u64
+{
+    auto const n_cols = input.at(0).size();
+    auto const n_rows = input.size() - 1;
+
+    return flux::ints(0, n_cols)
+        .chunk_by([&ops = input.back()](flux::index_t, flux::index_t idx) {
+            return ops.at(idx) != '+' && ops.at(idx) != '*';
+        })
+        .map([&input, n_rows](auto col_rng) {
+            char op = input.back().at(col_rng.front().value());
+            u64 id = op == '+' ? 0 : 1;
+            return std::move(col_rng)
+                .map([&input, n_rows, id](flux::index_t col_idx) {
+                    auto seq =
+                        flux::ints(0, n_rows).map([&, col_idx](auto row_idx) {
+                            return input.at(row_idx).at(col_idx);
+                        });
+                    return aoc::try_parse<u64>(seq).value_or(id);
+                })
+                .fold(
+                    [op](u64 acc, u64 val) -> u64 {
+                        return op == '+' ? acc + val : acc * val;
+                    },
+                    id);
+        })
+        .sum();
+}
+
+[[gnu::noinline]] auto dec06_loop(lines_t const& input) -> u64
+{
+    auto const& ops = input.back();
+    auto const n_cols = input.at(0).size();
+    auto const n_rows = input.size() - 1;
+
+    u64 total = 0;
+    for (std::size_t col = 0; col < n_cols;) {
+        char const op = ops[col];
+        u64 const id = op == '+' ? 0 : 1;
+        u64 acc = id;
+        do {
+            // Same rules as try_parse: skip leading spaces, then read digits
+            // until anything else. Separator columns have no digits at all.
+            u64 val = 0;
+            bool any = false;
+            for (std::size_t row = 0; row < n_rows; ++row) {
+                char const c = input[row][col];
+                if (c >= '0' && c <= '9') {
+                    val = 10 * val + u64(c - '0');
+                    any = true;
+                } else if (any || c != ' ') {
+                    break;
+                }
+            }
+            val = any ? val : id;
+            acc = op == '+' ? acc + val : acc * val;
+            ++col;
+        } while (col < n_cols && ops[col] != '+' && ops[col] != '*');
+        total += acc;
+    }
+    return total;
+}
+
+// dec09 part 1: largest rectangle over every ordered pair of corners with
+// cartesian_power_map<2>
+using point = aoc::vec2_t<i64>;
+
+auto area(point const& a, point const& b) -> i64
+{
+    return (1 + aoc::abs(a.x - b.x)) * (1 + aoc::abs(a.y - b.y));
+}
+
+[[gnu::noinline]] auto dec09_flux(std::span<point const> tiles) -> i64
+{
+    return flux::cartesian_power_map<2>(flux::ref(tiles), area)
+        .max()
+        .value_or(0);
+}
+
+[[gnu::noinline]] auto dec09_loop(std::span<point const> tiles) -> i64
+{
+    i64 best = 0;
+    for (point const& a : tiles) {
+        for (point const& b : tiles) { best = std::max(best, area(a, b)); }
+    }
+    return best;
+}
+
+} // namespace kernels
+
+namespace {
+
+using rng = aoc::splitmix64;
+
+auto const make_offsets = [](rng& r, std::size_t n) {
+    return flux::iota(0uz, n)
+        .map([&](auto) { return int(r.between(0, 1998)) - 999; })
+        .to<std::vector>();
+};
+
+auto const make_grid = [](rng& r, int n) {
+    kernels::grid2d grid{.data = {}, .width = n, .height = n};
+    for (auto _ : flux::iota(0, n * n)) {
+        grid.data += r.between(0, 9) < 6 ? '@' : '.';
+    }
+    return grid;
+};
+
+// Every number in a problem has the same number of digits, so each column
+// of digits is unbroken
+auto const make_worksheet = [](rng& r, std::size_t n_problems) {
+    kernels::lines_t lines(5);
+    for (auto i : flux::iota(0uz, n_problems)) {
+        auto const width = r.between(1, 4);
+        for (auto& line : lines) {
+            if (i != 0) { line += ' '; }
+        }
+        for (auto row : flux::iota(0, 4)) {
+            for (auto _ : flux::iota(0uz, width)) {
+                lines[row] += char('0' + r.between(1, 9));
+            }
+        }
+        lines[4] += r.between(0, 1) ? '+' : '*';
+        lines[4] += std::string(width - 1, ' ');
+    }
+    return lines;
+};
+
+auto const make_tiles = [](rng& r, std::size_t n) {
+    return flux::iota(0uz, n)
+        .map([&](auto) {
+            return kernels::point{i64(r.between(0, 100'000)),
+                                  i64(r.between(0, 100'000))};
+        })
+        .to<std::vector>();
+};
+
+// Best of several runs, in nanoseconds
+template <typename F, typename Input>
+auto best_time(int runs, F kernel, Input const& input)
+{
+    auto best = aoc::timed<std::chrono::nanoseconds>(kernel, input);
+    for (auto _ : flux::iota(1, runs)) {
+        auto const run = aoc::timed<std::chrono::nanoseconds>(kernel, input);
+        if (run.first != best.first) {
+            throw std::runtime_error("Inconsistent result");
+        }
+        best.second = std::min(best.second, run.second);
+    }
+    return std::pair(best.first, double(best.second.count()));
+}
+
+template <typename FluxFn, typename LoopFn, typename Input>
+auto compare(std::string_view name, std::size_t n_elements, int runs,
+             FluxFn flux_fn, LoopFn loop_fn, Input const& input) -> bool
+{
+    auto const [flux_res, flux_ns] = best_time(runs, flux_fn, input);
+    auto const [loop_res, loop_ns] = best_time(runs, loop_fn, input);
+
+    auto const rate = [&](double ns) { return double(n_elements) / ns * 1e3; };
+    std::println("{:<8} {:>12} {:>14.2f} {:>14.2f} {:>9.2f}x{}", name,
+                 n_elements, rate(flux_ns), rate(loop_ns), flux_ns / loop_ns,
+                 flux_res == loop_res ? "" : "  MISMATCH");
+    return flux_res == loop_res;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Inputs grow linearly with the scale, except for the grid and the
+    // tiles, whose work grows with the square of their size
+    auto const scale =
+        argc > 1 ? aoc::parse<std::size_t>(std::string_view(argv[1])) : 1;
+    auto const runs = argc > 2 ? aoc::parse<int>(std::string_view(argv[2])) : 5;
+    auto const side = 2000 * std::sqrt(double(scale));
+
+    rng r{2025};
+    auto const offsets = make_offsets(r, 10'000'000 * scale);
+    auto const grid = make_grid(r, int(side));
+    auto const worksheet = make_worksheet(r, 200'000 * scale);
+    auto const tiles = make_tiles(r, std::size_t(side));
+
+    std::println("{:<8} {:>12} {:>14} {:>14} {:>10}", "kernel", "elements",
+                 "flux (M/s)", "loop (M/s)", "flux/loop");
+
+    bool ok = true;
+    ok &= compare("dec01", offsets.size(), runs, kernels::dec01_flux,
+                  kernels::dec01_loop, std::span<int const>(offsets));
+    ok &= compare("dec04", grid.data.size(), runs, kernels::dec04_flux,
+                  kernels::dec04_loop, grid);
+    ok &= compare("dec06", worksheet.at(0).size(), runs, kernels::dec06_flux,
+                  kernels::dec06_loop, worksheet);
+    ok &= compare("dec09", tiles.size() * tiles.size(), runs,
+                  kernels::dec09_flux, kernels::dec09_loop,
+                  std::span<kernels::point const>(tiles));
+    return ok ? 0 : 1;
+}
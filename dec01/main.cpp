@@ -3,23 +3,22 @@ import aoc;
 
 namespace {
 
-constexpr auto parse_input = [](std::string_view input) {
-    return flux::split_string(input, '\n')
-        .filter([](std::string_view line) { return !line.empty(); })
-        .map([](std::string_view line) {
-            int dist = aoc::parse<int>(line.substr(1));
-            return line.at(0) == 'L' ? -dist : dist;
-        })
-        .to<std::vector>();
+constexpr auto read_rotation = [](aoc::scanner& sc) -> int {
+    return sc.consume('L') ? -sc.read<int>() : sc.expect('R').read<int>();
 };
 
-constexpr auto part1 = [](std::vector<int> const& offsets) {
+constexpr auto parse_input = [](std::string_view input,
+                                aoc::arena_allocator<> alloc = {}) {
+    return aoc::parse_lines(input, read_rotation, alloc);
+};
+
+constexpr auto part1 = [](aoc::arena_vector<int> const& offsets) {
     return flux::ref(offsets).scan(std::plus{}, 50).count_if([](int i) {
         return i % 100 == 0;
     });
 };
 
-constexpr auto part2 = [](std::vector<int> const& offsets) {
+constexpr auto part2 = [](aoc::arena_vector<int> const& offsets) {
     int zero_count = 0;
     int pos = 50;
 
@@ -37,6 +36,68 @@ constexpr auto part2 = [](std::vector<int> const& offsets) {
     return zero_count;
 };
 
+// Computes both parts in a single pass straight off the input text, for
+// inputs too big to parse up front. Positions are 64-bit and never reduced
+// mod 100: instead they start from a large multiple of 100, so they stay
+// positive and floor division is plain unsigned division. Rotations are
+// parsed a block at a time, and then the zero counts for the whole block are
+// computed without branches.
+struct dial {
+    using u64 = std::uint64_t;
+
+    static constexpr std::size_t block_size = 512;
+
+    u64 pos = 100 * (u64{1} << 50) + 50;
+    u64 stopped_at_zero = 0;
+    u64 passed_zero = 0;
+
+    // Takes any number of complete lines
+    constexpr void feed(std::string_view text)
+    {
+        std::array<u64, block_size + 1> positions;
+        std::size_t i = 0;
+
+        while (i < text.size()) {
+            positions[0] = pos;
+            std::size_t n = 0;
+
+            while (n < block_size && i < text.size()) {
+                char const dir = text[i++];
+                if (dir == '\n' || dir == '\r') { continue; }
+                // Like aoc::parse, stop at the first non-digit (such as a
+                // '\r'), and skip whatever else is on the line
+                u64 dist = 0;
+                for (; i < text.size() && text[i] >= '0' && text[i] <= '9';
+                     ++i) {
+                    dist = dist * 10 + u64(text[i] - '0');
+                }
+                while (i < text.size() && text[i] != '\n') { ++i; }
+                pos = dir == 'L' ? pos - dist : pos + dist;
+                positions[++n] = pos;
+            }
+
+            for (std::size_t j = 0; j < n; ++j) {
+                u64 const from = positions[j];
+                u64 const to = positions[j + 1];
+                // Moving right we pass through (from, to], moving left through
+                // [to, from): shifting the latter down by one makes both of
+                // them (lo, hi]
+                u64 const left = to < from;
+                u64 const hi = std::max(from, to) - left;
+                u64 const lo = std::min(from, to) - left;
+                stopped_at_zero += to % 100 == 0;
+                passed_zero += hi / 100 - lo / 100;
+            }
+        }
+    }
+};
+
+constexpr auto solve = [](std::string_view input) {
+    dial d;
+    d.feed(input);
+    return std::pair(d.stopped_at_zero, d.passed_zero);
+};
+
 constexpr std::string_view test_input =
     R"(L68
 L30
@@ -52,9 +113,24 @@ L82
 
 static_assert(part1(parse_input(test_input)) == 3);
 static_assert(part2(parse_input(test_input)) == 6);
+static_assert(solve(test_input).first == 3);
+static_assert(solve(test_input).second == 6);
 
 } // namespace
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answers = solve(embedded_input);
+    std::println("Part 1: {}", answers.first);
+    std::println("Part 2: {}", answers.second);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -62,8 +138,20 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    auto const input = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(solve, [](auto const& answers) {
+            return std::format("Part 1: {}\nPart 2: {}", answers.first,
+                               answers.second);
+        });
+    }
+
+    dial d;
+    for (std::string_view lines : aoc::block_stream(argv[1], 1 << 20)) {
+        d.feed(lines);
+    }
+
+    std::println("Part 1: {}", d.stopped_at_zero);
+    std::println("Part 2: {}", d.passed_zero);
+}
 
-    std::println("Part 1: {}", part1(input));
-    std::println("Part 2: {}", part2(input));
-}
\ No newline at end of file
+#endif
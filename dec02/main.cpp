@@ -18,17 +18,18 @@ auto const to_string = [](u64 val) -> std::string {
     return out;
 };
 
+// Each range is summed as a single task, as the ranges are independent
 template <ctll::fixed_string Regex>
 auto const test_ranges = [](std::string_view input) -> u64 {
-    return flux::map(ctre::search_all<"(\\d+)-(\\d+)">(input),
-                     [](auto match) {
-                         auto [_, lo, hi] = match;
-                         return flux::iota(aoc::parse<u64>(lo),
-                                           1 + aoc::parse<u64>(hi));
-                     })
-        .flatten()
-        .filter([](u64 value) { return ctre::match<Regex>(to_string(value)); })
-        .sum();
+    return aoc::parallel_sum(flux::map(
+        ctre::search_all<"(\\d+)-(\\d+)">(input), [](auto match) -> u64 {
+            auto [_, lo, hi] = match;
+            return flux::iota(aoc::parse<u64>(lo), 1 + aoc::parse<u64>(hi))
+                .filter(aoc::counted("dec02 ids tested", [](u64 value) {
+                    return ctre::match<Regex>(to_string(value));
+                }))
+                .sum();
+        }));
 };
 
 auto const part1 = test_ranges<"(\\d+)\\1">;
@@ -45,6 +46,20 @@ static_assert(part2(test_data) == 4174379265);
 
 } // namespace
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answer1 = part1(embedded_input);
+    constexpr auto answer2 = part2(embedded_input);
+    std::println("Part 1: {}", answer1);
+    std::println("Part 2: {}", answer2);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -52,8 +67,19 @@ int main(int argc, char** argv)
         return -1;
     }
 
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(
+            [](std::string_view text) { return text; },
+            [](std::string_view input) {
+                return std::format("Part 1: {}\nPart 2: {}", part1(input),
+                                   part2(input));
+            });
+    }
+
     std::string const input = aoc::string_from_file(argv[1]);
 
     std::println("Part 1: {}", part1(input));
     std::println("Part 2: {}", part2(input));
-}
\ No newline at end of file
+}
+
+#endif
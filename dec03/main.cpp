@@ -1,4 +1,6 @@
 
+#include <flux/macros.hpp>
+
 import aoc;
 
 using u64 = std::uint64_t;
@@ -24,15 +26,100 @@ auto const calculate_joltage = [](std::string_view line) -> u64 {
 
 template <std::size_t N>
 auto const solve = [](std::string_view input) {
-    return flux::split_string(input, '\n')
-        .filter([](std::string_view line) { return !line.empty(); })
-        .map(calculate_joltage<N>)
-        .sum();
+    return aoc::parallel_sum(
+        flux::split_string(input, '\n')
+            .filter([](std::string_view line) { return !line.empty(); })
+            .map(calculate_joltage<N>));
 };
 
 auto const part1 = solve<2>;
 auto const part2 = solve<12>;
 
+// For files too big to load: both parts in one pass, in constant memory
+auto const solve_stream = [](char const* path) -> std::pair<u64, u64> {
+    std::pair<u64, u64> totals{};
+    for (std::string_view line : aoc::line_stream(path)) {
+        if (line.empty()) { continue; }
+        totals.first += calculate_joltage<2>(line);
+        totals.second += calculate_joltage<12>(line);
+    }
+    return totals;
+};
+
+// Batch mode, for inputs where every line has the same length. Lines are
+// taken 32 at a time and transposed, so that cols[j] holds digit j of each
+// of the 32 lines in its own lane. Every lane then makes the same greedy
+// choices as calculate_joltage, using vector compares and blends: for each
+// digit, a lane's best so far is only replaced by a strictly greater digit
+// at or after that lane's start, which finds the first maximum. Positions
+// are kept in bytes, so lines can be at most 255 digits long.
+using u8x32 = std::uint8_t __attribute__((vector_size(32)));
+constexpr std::size_t lanes = 32;
+
+template <std::size_t N>
+auto const batch_joltage = [](std::span<u8x32 const> cols) -> u64 {
+    std::array<u64, lanes> jolts{};
+    u8x32 start{};
+
+    for (std::size_t i = 0; i < N; ++i) {
+        u8x32 best{};
+        u8x32 best_pos = start;
+        for (std::size_t j = 0; j < cols.size() - N + i + 1; ++j) {
+            u8x32 const pos = u8x32{} + std::uint8_t(j);
+            auto const take = (u8x32) ((cols[j] > best) & (pos >= start));
+            best = (best & ~take) | (cols[j] & take);
+            best_pos = (best_pos & ~take) | (pos & take);
+        }
+        start = best_pos + 1;
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            jolts[lane] = 10 * jolts[lane] + best[lane];
+        }
+    }
+
+    return flux::sum(jolts);
+};
+
+// Both parts at once, or nullopt if the lines are ragged (or too long), in
+// which case the per-line path has to be used instead
+auto const solve_batched
+    = [](std::string_view input) -> std::optional<std::pair<u64, u64>> {
+    auto const idx = aoc::index_structure(input);
+    auto const width = idx.width;
+    auto const stride = width + 1;
+    bool const uniform = width >= 12 && width <= 255
+        && input.size() == idx.height * stride
+        && flux::iota(0uz, idx.height).all([&](std::size_t row) {
+               return idx.newlines[row] == row * stride + width;
+           });
+    if (!uniform) { return std::nullopt; }
+
+    auto const n_batches = idx.height / lanes;
+    std::vector<std::pair<u64, u64>> results(n_batches);
+    aoc::parallel_for(n_batches, [&](std::size_t batch) {
+        std::array<u8x32, 255> cols;
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            auto const line = idx.line(input, batch * lanes + lane);
+            for (std::size_t j = 0; j < width; ++j) {
+                cols[j][lane] = std::uint8_t(line[j] - '0');
+            }
+        }
+        auto const digits = std::span<u8x32 const>(cols.data(), width);
+        results[batch] = {batch_joltage<2>(digits), batch_joltage<12>(digits)};
+    });
+
+    std::pair<u64, u64> totals{};
+    for (auto [p1, p2] : results) {
+        totals.first += p1;
+        totals.second += p2;
+    }
+    // The lines left over after the last full batch
+    for (auto row : flux::iota(n_batches * lanes, idx.height)) {
+        totals.first += calculate_joltage<2>(idx.line(input, row));
+        totals.second += calculate_joltage<12>(idx.line(input, row));
+    }
+    return totals;
+};
+
 constexpr auto& test_data =
     R"(987654321111111
 811111111111119
@@ -43,15 +130,61 @@ constexpr auto& test_data =
 static_assert(part1(test_data) == 357);
 static_assert(part2(test_data) == 3121910778619);
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answer1 = part1(embedded_input);
+    constexpr auto answer2 = part2(embedded_input);
+    std::println("Part 1: {}", answer1);
+    std::println("Part 2: {}", answer2);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
+    // Enough copies of the example for one full batch plus some left over
+    auto const batch_test = flux::repeat(std::string_view(test_data), 9)
+                                .flatten()
+                                .to<std::string>();
+    FLUX_ASSERT(solve_batched(batch_test)
+                == std::pair<u64, u64>(9 * 357, 9 * 3121910778619));
+
     if (argc < 2) {
         std::println(std::cerr, "No input");
         return -1;
     }
 
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(
+            [](std::string_view text) { return text; },
+            [](std::string_view input) {
+                return std::format("Part 1: {}\nPart 2: {}", part1(input),
+                                   part2(input));
+            });
+    }
+
+    // Streaming gives up on threads, so only do it when we have to
+    if (std::filesystem::file_size(argv[1]) > (std::uintmax_t{1} << 30)) {
+        auto const [answer1, answer2] = solve_stream(argv[1]);
+        std::println("Part 1: {}", answer1);
+        std::println("Part 2: {}", answer2);
+        return 0;
+    }
+
     std::string const input = aoc::string_from_file(argv[1]);
 
+    if (auto answers = solve_batched(input)) {
+        std::println("Part 1: {}", answers->first);
+        std::println("Part 2: {}", answers->second);
+        return 0;
+    }
+
     std::println("Part 1: {}", part1(input));
     std::println("Part 2: {}", part2(input));
-}
\ No newline at end of file
+}
+
+#endif
@@ -1,10 +1,12 @@
 
+#include <flux/macros.hpp>
+
 import aoc;
 
 using coord = aoc::vec2_t<int>;
 
 struct grid2d {
-    std::string data;
+    aoc::arena_string data;
     int width;
     int height;
 
@@ -34,11 +36,17 @@ struct grid2d {
     }
 };
 
-auto const parse_input = [](std::string_view input) -> grid2d {
-    return grid2d{
-        .data = flux::filter(input, flux::pred::in('.', '@')).to<std::string>(),
-        .width = int(flux::find(input, '\n')),
-        .height = int(flux::count_eq(input, '\n'))};
+auto const parse_input = [](std::string_view input,
+                            aoc::arena_allocator<> alloc = {}) -> grid2d {
+    auto const idx = aoc::index_structure(input, std::nullopt, alloc);
+    aoc::arena_string data(alloc);
+    data.reserve(idx.width * idx.height);
+    for (auto row : flux::iota(0uz, idx.height)) {
+        data += idx.line(input, row);
+    }
+    return grid2d{.data = std::move(data),
+                  .width = int(idx.width),
+                  .height = int(idx.height)};
 };
 
 auto const can_access = [](grid2d const& grid, coord pos) -> bool {
@@ -76,6 +84,79 @@ auto const part2 = [](grid2d grid) {
     }
 };
 
+// Tiled versions of both parts for large grids. The grid is split into
+// tiles of whole rows, sized so that a tile plus the halo rows above and
+// below it fit in L2, and the tiles are processed in parallel.
+auto const default_tile_rows = [](grid2d const& grid) -> int {
+    return std::max(1, (256 << 10) / std::max(grid.width, 1));
+};
+
+auto const part1_tiled = [](grid2d const& grid,
+                            int tile_rows = 0) -> flux::distance_t {
+    if (tile_rows <= 0) { tile_rows = default_tile_rows(grid); }
+    auto const n_tiles = std::size_t((grid.height + tile_rows - 1) / tile_rows);
+
+    std::vector<flux::distance_t> counts(n_tiles);
+    aoc::parallel_for(n_tiles, [&](std::size_t t) {
+        int const y0 = int(t) * tile_rows;
+        int const y1 = std::min(y0 + tile_rows, grid.height);
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < grid.width; ++x) {
+                coord const pos{x, y};
+                counts[t] += grid[pos] == '@' && can_access(grid, pos);
+            }
+        }
+    });
+    return flux::sum(counts);
+};
+
+// Each round reads one buffer and writes the next, so the tiles don't see
+// each other's removals until the following round. That can take more
+// rounds than the in-place serial version, but the total is the same:
+// removing rolls never makes another roll inaccessible, so both reach the
+// same fixed point. A tile is only redone if it or one of its neighbours
+// changed in the previous round; otherwise both buffers already agree.
+auto const part2_tiled = [](grid2d const& grid, int tile_rows = 0) -> int {
+    if (tile_rows <= 0) { tile_rows = default_tile_rows(grid); }
+    auto const n_tiles = std::size_t((grid.height + tile_rows - 1) / tile_rows);
+
+    std::array<grid2d, 2> buffers{grid, grid};
+    grid2d* cur = &buffers[0];
+    grid2d* next = &buffers[1];
+    std::vector<char> changed(n_tiles, true);
+    std::vector<int> removed(n_tiles);
+    int total_removed = 0;
+
+    while (true) {
+        aoc::parallel_for(n_tiles, [&](std::size_t t) {
+            removed[t] = 0;
+            bool const active = changed[t] || (t > 0 && changed[t - 1])
+                || (t + 1 < n_tiles && changed[t + 1]);
+            if (!active) { return; }
+
+            int const y0 = int(t) * tile_rows;
+            int const y1 = std::min(y0 + tile_rows, grid.height);
+            for (int y = y0; y < y1; ++y) {
+                for (int x = 0; x < grid.width; ++x) {
+                    coord const pos{x, y};
+                    char const c = (*cur)[pos];
+                    bool const remove = c == '@' && can_access(*cur, pos);
+                    (*next)[pos] = remove ? '.' : c;
+                    removed[t] += remove;
+                }
+            }
+        });
+
+        int const round_removed = flux::sum(removed);
+        if (round_removed == 0) { return total_removed; }
+        total_removed += round_removed;
+        for (auto t : flux::iota(0uz, n_tiles)) {
+            changed[t] = removed[t] > 0;
+        }
+        std::swap(cur, next);
+    }
+};
+
 constexpr auto& test_data =
     R"(..@@.@@@@.
 @@@.@.@.@@
@@ -92,15 +173,44 @@ constexpr auto& test_data =
 static_assert(part1(parse_input(test_data)) == 13);
 static_assert(part2(parse_input(test_data)) == 43);
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answer1 = part1(parse_input(embedded_input));
+    constexpr auto answer2 = part2(parse_input(embedded_input));
+    std::println("Part 1: {}", answer1);
+    std::println("Part 2: {}", answer2);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
+    // The tiled versions use threads, so can't be tested at compile time.
+    // Tiles of three rows make sure the halos get exercised.
+    FLUX_ASSERT(part1_tiled(parse_input(test_data), 3) == 13);
+    FLUX_ASSERT(part2_tiled(parse_input(test_data), 3) == 43);
+
     if (argc < 2) {
         std::println(std::cerr, "No input");
         return -1;
     }
 
-    grid2d const grid = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(parse_input, [](grid2d const& grid) {
+            return std::format("Part 1: {}\nPart 2: {}", part1_tiled(grid),
+                               part2_tiled(grid));
+        });
+    }
+
+    aoc::arena arena;
+    grid2d const grid = parse_input(aoc::string_from_file(argv[1]), arena);
+
+    std::println("Part 1: {}", part1_tiled(grid));
+    std::println("Part 2: {}", part2_tiled(grid));
+}
 
-    std::println("Part 1: {}", part1(grid));
-    std::println("Part 2: {}", part2(grid));
-}
\ No newline at end of file
+#endif
@@ -1,4 +1,6 @@
 
+#include <flux/macros.hpp>
+
 import aoc;
 
 using u64 = std::uint64_t;
@@ -10,50 +12,60 @@ struct id_range {
     friend auto operator<=>(id_range, id_range) = default;
 };
 
-auto const parse_ranges = [](std::string_view input) -> std::vector<id_range> {
-    return flux::split_string(input, '\n')
-        .map([](std::string_view line) {
-            auto dash = line.find('-');
-            return id_range{aoc::parse<u64>(line.substr(0, dash)),
-                            aoc::parse<u64>(line.substr(dash + 1))};
-        })
-        .to<std::vector>();
+auto const read_range = [](aoc::scanner& sc) -> id_range {
+    auto const lo = sc.read<u64>();
+    return id_range{lo, sc.expect('-').read<u64>()};
+};
+
+auto const parse_range = [](std::string_view line) -> id_range {
+    aoc::scanner sc(line);
+    return read_range(sc);
+};
+
+auto const parse_ranges = [](std::string_view input,
+                             aoc::arena_allocator<> alloc = {})
+    -> aoc::arena_vector<id_range> {
+    return aoc::parse_lines(input, read_range, alloc);
 };
 
-auto const parse_ids = [](std::string_view input) -> std::vector<u64> {
-    return flux::split_string(input, '\n')
-        .filter([](std::string_view line) { return !line.empty(); })
-        .map(aoc::parse<u64>)
-        .to<std::vector>();
+auto const parse_ids = [](std::string_view input,
+                          aoc::arena_allocator<> alloc = {})
+    -> aoc::arena_vector<u64> {
+    return aoc::parse_lines(
+        input, [](aoc::scanner& sc) { return sc.read<u64>(); }, alloc);
 };
 
-auto const parse_input = [](std::string_view input)
-    -> std::pair<std::vector<id_range>, std::vector<u64>> {
+auto const parse_input
+    = [](std::string_view input, aoc::arena_allocator<> alloc = {})
+    -> std::pair<aoc::arena_vector<id_range>, aoc::arena_vector<u64>> {
     auto blank = input.find("\n\n");
-    return {parse_ranges(input.substr(0, blank)),
-            parse_ids(input.substr(blank + 2))};
+    return {parse_ranges(input.substr(0, blank), alloc),
+            parse_ids(input.substr(blank + 2), alloc)};
 };
 
-auto const part1 = [](std::vector<id_range> const& ranges,
-                      std::vector<u64> const& ids) {
-    return flux::count_if(ids, [&](u64 id) {
-        return flux::any(ranges, [id](id_range const& rng) {
-            return id >= rng.lo && id <= rng.hi;
-        });
+auto const is_fresh = [](aoc::arena_vector<id_range> const& ranges,
+                         u64 id) -> bool {
+    return flux::any(ranges, [id](id_range const& rng) {
+        return id >= rng.lo && id <= rng.hi;
     });
 };
 
+auto const part1 = [](aoc::arena_vector<id_range> const& ranges,
+                      aoc::arena_vector<u64> const& ids) {
+    return flux::count_if(ids, [&](u64 id) { return is_fresh(ranges, id); });
+};
+
 auto const disjoint = [](id_range const& lhs, id_range const& rhs) -> bool {
     return (lhs.hi < rhs.lo) || (rhs.hi < lhs.lo);
 };
 
 // Algorithm: repeatedly merge ranges until we can't do so any more,
 // then total up the number of ids covered
-auto const part2 = [](std::vector<id_range> ranges) -> u64 {
+auto const part2 = [](aoc::arena_vector<id_range> ranges) -> u64 {
     // Pre-sort the ranges to increase the chances of finding an early overlap
     flux::sort(ranges);
 
-    std::vector<id_range> next;
+    aoc::arena_vector<id_range> next(ranges.get_allocator());
     next.reserve(ranges.size());
 
     while (true) {
@@ -79,6 +91,60 @@ auto const part2 = [](std::vector<id_range> ranges) -> u64 {
         .sum();
 };
 
+// An incremental version of both parts, for ranges and ids arriving in any
+// order. The ranges are kept coalesced in a map from lo to hi, along with
+// the total number of ids they cover. Ids added with add_id() which aren't
+// fresh yet are kept too, in case a later range covers them, so memory grows
+// with the number of them. Once no more ranges can arrive, count_id() just
+// counts. Each insertion is O(log n) amortised, since every range or id is
+// erased at most once.
+struct freshness_index {
+    std::map<u64, u64> ranges;
+    std::map<u64, u64> stale_ids; // id -> number of times seen
+    u64 covered = 0;
+    u64 fresh_count = 0;
+
+    auto contains(u64 id) const -> bool
+    {
+        auto iter = ranges.upper_bound(id);
+        return iter != ranges.begin() && id <= std::prev(iter)->second;
+    }
+
+    void add_range(id_range rng)
+    {
+        // Start from the last range beginning at or before rng.lo, if it
+        // overlaps or touches, and absorb everything up to rng.hi + 1
+        auto iter = ranges.upper_bound(rng.lo);
+        if (iter != ranges.begin() && std::prev(iter)->second + 1 >= rng.lo) {
+            --iter;
+        }
+        while (iter != ranges.end() && iter->first <= rng.hi + 1) {
+            rng.lo = std::min(rng.lo, iter->first);
+            rng.hi = std::max(rng.hi, iter->second);
+            covered -= 1 + iter->second - iter->first;
+            iter = ranges.erase(iter);
+        }
+        ranges.emplace_hint(iter, rng.lo, rng.hi);
+        covered += 1 + rng.hi - rng.lo;
+
+        auto first = stale_ids.lower_bound(rng.lo);
+        auto last = stale_ids.upper_bound(rng.hi);
+        for (auto i = first; i != last; ++i) { fresh_count += i->second; }
+        stale_ids.erase(first, last);
+    }
+
+    void add_id(u64 id)
+    {
+        if (contains(id)) {
+            ++fresh_count;
+        } else {
+            ++stale_ids[id];
+        }
+    }
+
+    void count_id(u64 id) { fresh_count += contains(id); }
+};
+
 constexpr auto& test_data =
     R"(3-5
 10-14
@@ -99,16 +165,84 @@ auto const test = [] -> bool {
 };
 static_assert(test());
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answers = [] {
+        auto const [rngs, ids] = parse_input(embedded_input);
+        return std::pair{part1(rngs, ids), part2(rngs)};
+    }();
+    std::println("Part 1: {}", answers.first);
+    std::println("Part 2: {}", answers.second);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
+    // std::map isn't constexpr, so the index is tested at run time, both in
+    // file order and with the ids first
+    auto const test_index = [](bool ids_first) {
+        auto const input = parse_input(test_data);
+        freshness_index index;
+        auto const add_ids = [&] {
+            for (u64 id : input.second) { index.add_id(id); }
+        };
+        if (ids_first) { add_ids(); }
+        for (id_range rng : input.first) { index.add_range(rng); }
+        if (!ids_first) { add_ids(); }
+        return index.fresh_count == 3 && index.covered == 14;
+    };
+    FLUX_ASSERT(test_index(false));
+    FLUX_ASSERT(test_index(true));
+    {
+        // As main reads a sectioned file, where the ids are only counted
+        auto const [rngs, ids] = parse_input(test_data);
+        freshness_index index;
+        for (id_range rng : rngs) { index.add_range(rng); }
+        for (u64 id : ids) { index.count_id(id); }
+        FLUX_ASSERT(index.fresh_count == 3 && index.stale_ids.empty());
+    }
+
     if (argc < 2) {
         std::println(std::cerr, "No input");
         return -1;
     }
 
-    auto const [rngs, ids] = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(parse_input, [](auto const& input) {
+            auto const& [ranges, ids] = input;
+            return std::format("Part 1: {}\nPart 2: {}", part1(ranges, ids),
+                               part2(ranges));
+        });
+    }
+
+    // Records are applied as they stream past, so ranges and ids may come
+    // in any order. In the usual layout a blank line separates the ranges
+    // from the ids, and after that the ids are only counted, so part 1 runs
+    // in constant memory. Without one, unmatched ids have to be kept.
+    freshness_index index;
+    bool sectioned = false;
+    for (std::string_view line : aoc::line_stream(argv[1])) {
+        if (line.empty()) {
+            sectioned = !index.ranges.empty();
+        } else if (line.contains('-')) {
+            if (sectioned) {
+                throw std::runtime_error("Range found after the ids");
+            }
+            index.add_range(parse_range(line));
+        } else if (sectioned) {
+            index.count_id(aoc::parse<u64>(line));
+        } else {
+            index.add_id(aoc::parse<u64>(line));
+        }
+    }
+
+    std::println("Part 1: {}", index.fresh_count);
+    std::println("Part 2: {}", index.covered);
+}
 
-    std::println("Part 1: {}", part1(rngs, ids));
-    auto [soln, time] = aoc::timed(part2, rngs);
-    std::println("Part 2: {} ({})", soln, time);
-}
\ No newline at end of file
+#endif
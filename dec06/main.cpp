@@ -3,15 +3,23 @@ import aoc;
 
 using u64 = std::uint64_t;
 
-auto const parse_input =
-    [](std::string_view input) -> std::vector<std::string> {
+using lines_t = aoc::arena_vector<aoc::arena_string>;
+
+auto const parse_input = [](std::string_view input,
+                            aoc::arena_allocator<> alloc = {}) -> lines_t {
+    aoc::zone zone("dec06 parse");
+
     return flux::split_string(input, '\n')
         .filter([](std::string_view line) { return !line.empty(); })
-        .map([](std::string_view line) { return std::string(line); })
-        .to<std::vector>();
+        .map([alloc](std::string_view line) {
+            return aoc::arena_string(line, alloc);
+        })
+        .to<lines_t>(alloc);
 };
 
-auto const part1 = [](std::vector<std::string> const& input) -> u64 {
+auto const part1 = [](lines_t const& input) -> u64 {
+    aoc::zone zone("dec06 part1");
+
     auto const& ops = flux::ref(input.back()).filter(flux::pred::in('+', '*'));
 
     auto totals =
@@ -35,7 +43,9 @@ auto const part1 = [](std::vector<std::string> const& input) -> u64 {
     return flux::sum(totals);
 };
 
-auto const part2 = [](std::vector<std::string> const& input) -> u64 {
+auto const part2 = [](lines_t const& input) -> u64 {
+    aoc::zone zone("dec06 part2");
+
     auto const n_cols = input.at(0).size();
     auto const n_rows = input.size() - 1;
 
@@ -72,6 +82,20 @@ constexpr auto& test_data = "123 328  51 64 \n"
 static_assert(part1(parse_input(test_data)) == 4277556);
 static_assert(part2(parse_input(test_data)) == 3263827);
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answer1 = part1(parse_input(embedded_input));
+    constexpr auto answer2 = part2(parse_input(embedded_input));
+    std::println("Part 1: {}", answer1);
+    std::println("Part 2: {}", answer2);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -79,7 +103,17 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    auto const input = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(parse_input, [](lines_t const& input) {
+            return std::format("Part 1: {}\nPart 2: {}", part1(input),
+                               part2(input));
+        });
+    }
+
+    aoc::arena arena;
+    auto const input = parse_input(aoc::string_from_file(argv[1]), arena);
     std::println("Part 1: {}", part1(input));
     std::println("Part 2: {}", part2(input));
-}
\ No newline at end of file
+}
+
+#endif
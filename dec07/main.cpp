@@ -4,7 +4,7 @@ import aoc;
 using u64 = std::uint64_t;
 
 struct grid2d {
-    std::string data;
+    aoc::arena_string data;
     int width;
     int height;
 
@@ -14,11 +14,17 @@ struct grid2d {
     }
 };
 
-auto const parse_input = [](std::string_view input) -> grid2d {
-    return {.data =
-                flux::filter(input, flux::pred::neq('\n')).to<std::string>(),
-            .width = (int) flux::find(input, '\n'),
-            .height = (int) flux::count_eq(input, '\n')};
+auto const parse_input = [](std::string_view input,
+                            aoc::arena_allocator<> alloc = {}) -> grid2d {
+    auto const idx = aoc::index_structure(input, std::nullopt, alloc);
+    aoc::arena_string data(alloc);
+    data.reserve(idx.width * idx.height);
+    for (auto row : flux::iota(0uz, idx.height)) {
+        data += idx.line(input, row);
+    }
+    return {.data = std::move(data),
+            .width = (int) idx.width,
+            .height = (int) idx.height};
 };
 
 auto const solve = [](grid2d const& grid) -> std::pair<int, u64> {
@@ -65,6 +71,19 @@ constexpr auto& test_data = R"(.......S.......
 
 static_assert(solve(parse_input(test_data)) == std::pair{21, 40});
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto result = solve(parse_input(embedded_input));
+    std::println("Part 1: {}", result.first);
+    std::println("Part 2: {}", result.second);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -72,9 +91,19 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    auto const grid = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(parse_input, [](auto const& grid) {
+            auto const [answer1, answer2] = solve(grid);
+            return std::format("Part 1: {}\nPart 2: {}", answer1, answer2);
+        });
+    }
+
+    aoc::arena arena;
+    auto const grid = parse_input(aoc::string_from_file(argv[1]), arena);
     auto [result, time] = aoc::timed(solve, grid);
     std::println("Part 1: {}", result.first);
     std::println("Part 2: {}", result.second);
-    std::println("Time: {}", time);
-}
\ No newline at end of file
+    std::println(std::cerr, "Time: {}", time);
+}
+
+#endif
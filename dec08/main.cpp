@@ -15,22 +15,23 @@ auto const dist2 = [](vec3 const& a, vec3 const& b) {
     return dx * dx + dy * dy + dz * dz;
 };
 
-auto const parse_input = [](std::string_view input) -> std::vector<vec3> {
-    return flux::split_string(input, '\n')
-        .filter([](std::string_view line) { return !line.empty(); })
-        .map([](std::string_view line) {
-            auto [x, y, z] = flux::split_string(line, ',')
-                                 .map(aoc::parse<int>)
-                                 .adjacent<3>()
-                                 .front()
-                                 .value();
-            return vec3{x, y, z};
-        })
-        .to<std::vector>();
+auto const read_box = [](aoc::scanner& sc) -> vec3 {
+    auto const x = sc.read<int>();
+    auto const y = sc.expect(',').read<int>();
+    auto const z = sc.expect(',').read<int>();
+    return vec3{x, y, z};
+};
+
+auto const parse_input = [](std::string_view input,
+                            aoc::arena_allocator<> alloc = {})
+    -> aoc::arena_vector<vec3> {
+    aoc::zone zone("dec08 parse");
+
+    return aoc::parse_lines(input, read_box, alloc);
 };
 
 template <int N>
-auto const part1 = [](std::vector<vec3> const& boxes) {
+auto const part1 = [](std::span<vec3 const> boxes) {
     // Create a list of pairs of box ids
     std::vector<std::pair<u32, u32>> pairs;
     for (auto i : flux::iota(0uz, boxes.size())) {
@@ -44,7 +45,10 @@ auto const part1 = [](std::vector<vec3> const& boxes) {
         return dist2(boxes[p.first], boxes[p.second]);
     };
 
-    std::ranges::make_heap(pairs, std::greater{}, proj);
+    {
+        aoc::zone zone("dec08 make_heap");
+        std::ranges::make_heap(pairs, std::greater{}, proj);
+    }
 
     // Create a list of circuits, where each circuit is a list of box ids
     // Initially each box is in its own circuit
@@ -56,21 +60,24 @@ auto const part1 = [](std::vector<vec3> const& boxes) {
     auto lights_to_circuits =
         flux::to<std::vector<u32>>(flux::iota(0uz, boxes.size()));
 
-    for (auto _ : flux::ints(0, N)) {
-        auto [box_id1, box_id2] = pairs.front();
-        auto circuit_id1 = lights_to_circuits[box_id1];
-        auto circuit_id2 = lights_to_circuits[box_id2];
+    {
+        aoc::zone zone("dec08 merge");
+        for (auto _ : flux::ints(0, N)) {
+            auto [box_id1, box_id2] = pairs.front();
+            auto circuit_id1 = lights_to_circuits[box_id1];
+            auto circuit_id2 = lights_to_circuits[box_id2];
 
-        auto& circuit1 = circuits[circuit_id1];
-        auto& circuit2 = circuits[circuit_id2];
+            auto& circuit1 = circuits[circuit_id1];
+            auto& circuit2 = circuits[circuit_id2];
 
-        circuit1 = flux::set_union(std::move(circuit1), std::move(circuit2))
-                       .template to<std::vector>();
+            circuit1 = flux::set_union(std::move(circuit1), std::move(circuit2))
+                           .template to<std::vector>();
 
-        for (auto id : circuit1) { lights_to_circuits[id] = circuit_id1; }
+            for (auto id : circuit1) { lights_to_circuits[id] = circuit_id1; }
 
-        std::ranges::pop_heap(pairs, std::greater{}, proj);
-        pairs.pop_back();
+            std::ranges::pop_heap(pairs, std::greater{}, proj);
+            pairs.pop_back();
+        }
     }
 
     std::ranges::partial_sort(circuits, circuits.begin() + 3,
@@ -79,7 +86,7 @@ auto const part1 = [](std::vector<vec3> const& boxes) {
     return flux::ref(circuits).map(flux::size).take(3).product();
 };
 
-auto const part2 = [](std::vector<vec3> const& boxes) -> i64 {
+auto const part2 = [](std::span<vec3 const> boxes) -> i64 {
     std::vector<std::pair<u32, u32>> pairs;
     for (auto i : flux::iota(0uz, boxes.size())) {
         for (auto j : flux::iota(i + 1, boxes.size())) {
@@ -91,7 +98,10 @@ auto const part2 = [](std::vector<vec3> const& boxes) -> i64 {
         return dist2(boxes[p.first], boxes[p.second]);
     };
 
-    std::ranges::make_heap(pairs, std::greater{}, proj);
+    {
+        aoc::zone zone("dec08 make_heap");
+        std::ranges::make_heap(pairs, std::greater{}, proj);
+    }
 
     auto circuits = flux::iota(0uz, boxes.size())
                         .map([](u32 i) { return std::vector{i}; })
@@ -100,6 +110,7 @@ auto const part2 = [](std::vector<vec3> const& boxes) -> i64 {
     auto lights_to_circuits =
         flux::to<std::vector<u32>>(flux::iota(0uz, boxes.size()));
 
+    aoc::zone zone("dec08 merge");
     while (true) {
         auto [box_id1, box_id2] = pairs.front();
         auto circuit_id1 = lights_to_circuits[box_id1];
@@ -151,6 +162,20 @@ constexpr auto& test_data =
 static_assert(part1<10>(parse_input(test_data)) == 40);
 static_assert(part2(parse_input(test_data)) == 25272);
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answer1 = part1<1000>(parse_input(embedded_input));
+    constexpr auto answer2 = part2(parse_input(embedded_input));
+    std::println("Part 1: {}", answer1);
+    std::println("Part 2: {}", answer2);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -158,8 +183,31 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    auto const boxes = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(parse_input, [](auto const& boxes) {
+            return std::format("Part 1: {}\nPart 2: {}", part1<1000>(boxes),
+                               part2(boxes));
+        });
+    }
+
+    auto const input = aoc::string_from_file(argv[1]);
+
+    // With AOC_CACHE_DIR set, the parsed boxes are saved after the first run
+    // and mapped straight back in on later ones
+    if (auto const cache = aoc::cache_file::load("dec08", input);
+        cache && cache->n_sections() == 1) {
+        auto const boxes = cache->section<vec3>(0);
+        std::println("Part 1: {}", part1<1000>(boxes));
+        std::println("Part 2: {}", part2(boxes));
+        return 0;
+    }
+
+    aoc::arena arena;
+    auto const boxes = parse_input(input, arena);
+    aoc::cache_store("dec08", input, std::span<vec3 const>(boxes));
 
     std::println("Part 1: {}", part1<1000>(boxes));
     std::println("Part 2: {}", part2(boxes));
-}
\ No newline at end of file
+}
+
+#endif
@@ -1,26 +1,30 @@
 
 import aoc;
-import ctre;
 
 using i64 = std::int64_t;
 using point = aoc::vec2_t<i64>;
 using line = std::pair<point, point>;
 
-auto const parse_input = [](std::string_view input) -> std::vector<point> {
-    return flux::map(ctre::search_all<"(\\d+),(\\d+)">(input),
-                     [](auto match) {
-                         auto [_, x, y] = match;
-                         return point{x.to_number(), y.to_number()};
-                     })
-        .to<std::vector>();
+auto const parse_input = [](std::string_view input,
+                            aoc::arena_allocator<> alloc = {})
+    -> aoc::arena_vector<point> {
+    return aoc::parse_lines(
+        input,
+        [](aoc::scanner& sc) {
+            auto const x = sc.read<i64>();
+            return point{x, sc.expect(',').read<i64>()};
+        },
+        alloc);
 };
 
 auto const area = [](point const& a, point const& b) -> i64 {
     return (1 + aoc::abs(a.x - b.x)) * (1 + aoc::abs(a.y - b.y));
 };
 
-auto const part1 = [](std::vector<point> const& tiles) {
-    return flux::cartesian_power_map<2>(flux::ref(tiles), area).max().value();
+auto const part1 = [](aoc::arena_vector<point> const& tiles) {
+    return aoc::parallel_max(
+               flux::cartesian_power_map<2>(flux::ref(tiles), area))
+        .value();
 };
 
 auto const intersects = [](line const& l1, line const& l2) -> bool {
@@ -34,7 +38,8 @@ auto const intersects = [](line const& l1, line const& l2) -> bool {
 };
 
 auto const check_intersections = [](point const& tl, point const& br,
-                                    std::vector<point> const& tiles) -> bool {
+                                    aoc::arena_vector<point> const& tiles)
+    -> bool {
     point tr{br.x, tl.y};
     point bl{tl.x, br.y};
     auto edges =
@@ -45,16 +50,24 @@ auto const check_intersections = [](point const& tl, point const& br,
         .none(flux::unpack(intersects));
 };
 
-auto const part2 = [](std::vector<point> const& tiles) {
-    return flux::cartesian_power<2>(flux::ref(tiles))
-        .filter(flux::unpack([&](point from, point to) {
-            if (from.x == to.x || from.y == to.y) { return false; }
-            point tl = {std::min(from.x, to.x) + 1, std::min(from.y, to.y) + 1};
-            point br = {std::max(from.x, to.x) - 1, std::max(from.y, to.y) - 1};
-            return check_intersections(tl, br, tiles);
-        }))
-        .map(flux::unpack(area))
-        .max()
+// Rejected pairs map to zero rather than being filtered out, so that the
+// pairs can be split between threads by index
+auto const part2 = [](aoc::arena_vector<point> const& tiles) {
+    aoc::zone zone("dec09 part2");
+
+    auto const check = aoc::counted("dec09 rectangles checked",
+                                    check_intersections, aoc::timing::on);
+
+    auto const rect_area = [&](point from, point to) -> i64 {
+        if (from.x == to.x || from.y == to.y) { return 0; }
+        point tl = {std::min(from.x, to.x) + 1, std::min(from.y, to.y) + 1};
+        point br = {std::max(from.x, to.x) - 1, std::max(from.y, to.y) - 1};
+        return check(tl, br, tiles) ? area(from, to) : 0;
+    };
+
+    return aoc::parallel_max(
+               flux::cartesian_power_map<2>(
+                   flux::ref(tiles), aoc::counted("dec09 pairs", rect_area)))
         .value_or(0);
 };
 
@@ -71,6 +84,20 @@ constexpr auto& test_data = R"(7,1
 static_assert(part1(parse_input(test_data)) == 50);
 static_assert(part2(parse_input(test_data)) == 24);
 
+#ifdef AOC_EMBEDDED_INPUT
+
+#    include AOC_EMBEDDED_INPUT
+
+int main()
+{
+    constexpr auto answer1 = part1(parse_input(embedded_input));
+    constexpr auto answer2 = part2(parse_input(embedded_input));
+    std::println("Part 1: {}", answer1);
+    std::println("Part 2: {}", answer2);
+}
+
+#else
+
 int main(int argc, char** argv)
 {
     if (argc < 2) {
@@ -78,7 +105,17 @@ int main(int argc, char** argv)
         return -1;
     }
 
-    auto const tiles = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(parse_input, [](auto const& tiles) {
+            return std::format("Part 1: {}\nPart 2: {}", part1(tiles),
+                               part2(tiles));
+        });
+    }
+
+    aoc::arena arena;
+    auto const tiles = parse_input(aoc::string_from_file(argv[1]), arena);
     std::println("Part 1: {}", part1(tiles));
     std::println("Part 2: {}", part2(tiles));
-}
\ No newline at end of file
+}
+
+#endif
@@ -4,54 +4,310 @@
 import aoc;
 
 using i64 = std::int64_t;
-using server_map_t = aoc::hash_map<std::string, std::vector<std::string>>;
-using cache_t = aoc::hash_map<std::string, i64>;
-
-auto const parse_input = [](std::string_view input) -> server_map_t {
-    return flux::split_string(input, '\n')
-        .filter([](std::string_view line) { return !line.empty(); })
-        .map([](std::string_view line) {
-            auto colon = line.find(':');
-            return std::pair{std::string(line.substr(0, colon)),
-                             flux::split_string(line.substr(colon + 2), ' ')
-                                 .to<std::vector<std::string>>()};
-        })
-        .to<server_map_t>();
+using u32 = std::uint32_t;
+using u128 = unsigned __int128;
+// Node names point into the input text, which must outlive the map
+using server_map_t
+    = aoc::hash_map<std::string_view, aoc::arena_vector<std::string_view>>;
+using cache_t = aoc::hash_map<std::string_view, std::vector<i64>>;
+
+auto const parse_input = [](std::string_view input,
+                            aoc::arena_allocator<> alloc = {}) -> server_map_t {
+    aoc::zone zone("dec11 parse");
+
+    server_map_t servers;
+    for (aoc::scanner sc(input); !sc.skip_whitespace().at_end();) {
+        auto const name = sc.read_word();
+        auto& outputs = servers.try_emplace(name, alloc).first->second;
+        sc.expect(':');
+        while (!sc.at_eol()) { outputs.push_back(sc.read_word()); }
+    }
+    return servers;
 };
 
-static i64 count_paths(server_map_t const& servers, std::string const& from,
-                       std::string const& to, cache_t& cache)
+// Adds the number of paths from `from` to `to` into `out`, bucketed by the
+// subset of waypoints visited along the way. Waypoint `i` corresponds to
+// bit `i` of the index into `out`.
+static void add_paths(server_map_t const& servers, std::string_view from,
+                      std::string_view to,
+                      std::span<std::string_view const> waypoints,
+                      cache_t& cache, std::span<i64> out)
 {
+    auto const n_masks = out.size();
+    std::size_t bit = 0;
+    if (auto idx = flux::find(waypoints, from); idx < flux::size(waypoints)) {
+        bit = std::size_t{1} << idx;
+    }
+
     if (from == to) {
-        return 1;
+        out[bit] += 1;
+        return;
     } else if (from == "out") {
-        return 0;
+        return;
     }
 
     if (auto iter = cache.find(from); iter != cache.cend()) {
-        return iter->second;
+        for (auto m : flux::iota(0uz, n_masks)) { out[m] += iter->second[m]; }
+        return;
+    }
+
+    std::vector<i64> sum(n_masks);
+    for (std::string_view next : servers.at(from)) {
+        add_paths(servers, next, to, waypoints, cache, sum);
     }
 
-    i64 res = flux::ref(servers.at(from))
-                  .map([&](std::string const& next) {
-                      return count_paths(servers, next, to, cache);
-                  })
-                  .sum();
-    cache[from] = res;
-    return res;
+    // Visiting this node sets its bit in every mask. Written as a select
+    // rather than a scatter so that it vectorises over the masks.
+    std::vector<i64> res(n_masks);
+    for (auto m : flux::iota(0uz, n_masks)) {
+        res[m] = (m & bit) != bit ? 0
+            : bit == 0            ? sum[m]
+                                  : sum[m] + sum[m ^ bit];
+        out[m] += res[m];
+    }
+    cache[from] = std::move(res);
 }
 
-auto const part1 = [](server_map_t const& servers) {
+// Counts the paths from `from` to `to` which visit every one of `waypoints`,
+// in any order, using a single memoised traversal of the graph
+static i64 count_paths(server_map_t const& servers, std::string_view from,
+                       std::string_view to,
+                       std::span<std::string_view const> waypoints = {})
+{
+    std::vector<i64> counts(std::size_t{1} << waypoints.size());
     cache_t cache{};
-    return count_paths(servers, "you", "out", cache);
+    add_paths(servers, from, to, waypoints, cache, counts);
+    return counts.back();
+}
+
+// Index-based form of the server map for large graphs. Nodes are grouped
+// into levels such that every successor of a node is in a lower level: sinks
+// are in level 0, and every other node is one above its highest successor.
+// All of the arrays are flat, so that a dag can be saved to and mapped back
+// from the parsed-input cache.
+struct dag {
+    // The name of node `i` is names[name_offsets[i], name_offsets[i + 1])
+    std::span<char const> names;
+    std::span<u32 const> name_offsets;
+    // Successors of node `i` are edges[offsets[i], offsets[i + 1])
+    std::span<u32 const> offsets;
+    std::span<u32 const> edges;
+    // Nodes in level `l` are levels[level_offsets[l], level_offsets[l + 1])
+    std::span<u32 const> levels;
+    std::span<std::uint64_t const> level_offsets;
+    // Owns whatever the spans above point into
+    std::shared_ptr<void const> storage;
+
+    auto size() const -> std::size_t { return offsets.size() - 1; }
+
+    auto name(u32 node) const -> std::string_view
+    {
+        return std::string_view(names.data() + name_offsets[node],
+                                name_offsets[node + 1] - name_offsets[node]);
+    }
+
+    // Only used for a handful of well-known nodes, so a linear search is fine
+    auto id(std::string_view node_name) const -> u32
+    {
+        for (auto node : flux::iota(u32{0}, u32(size()))) {
+            if (name(node) == node_name) { return node; }
+        }
+        throw std::out_of_range(std::format("No node named {}", node_name));
+    }
+
+    auto successors(u32 node) const -> std::span<u32 const>
+    {
+        return edges.subspan(offsets[node], offsets[node + 1] - offsets[node]);
+    }
+
+    void save(std::string_view input) const
+    {
+        aoc::cache_store("dec11", input, names, name_offsets, offsets, edges,
+                         levels, level_offsets);
+    }
+
+    static auto load(std::string_view input) -> std::optional<dag>
+    {
+        auto file = aoc::cache_file::load("dec11", input);
+        if (!file || file->n_sections() != 6) { return std::nullopt; }
+        auto const owner = std::make_shared<aoc::cache_file>(*std::move(file));
+        dag g{.names = owner->section<char>(0),
+              .name_offsets = owner->section<u32>(1),
+              .offsets = owner->section<u32>(2),
+              .edges = owner->section<u32>(3),
+              .levels = owner->section<u32>(4),
+              .level_offsets = owner->section<std::uint64_t>(5),
+              .storage = owner};
+
+        // Sizes which any real graph has, and which size() and id() rely on
+        if (g.offsets.empty() || g.level_offsets.empty()
+            || g.name_offsets.size() != g.offsets.size()
+            || g.levels.size() != g.size()) {
+            return std::nullopt;
+        }
+        return g;
+    }
 };
 
-// For both the test data and my input, 'fft' always precedes 'dac'
-auto const part2 = [](server_map_t const& servers) {
-    cache_t cache1{}, cache2{}, cache3{};
-    return count_paths(servers, "svr", "fft", cache1)
-        * count_paths(servers, "fft", "dac", cache2)
-        * count_paths(servers, "dac", "out", cache3);
+auto const make_dag = [](server_map_t const& servers) -> dag {
+    aoc::zone zone("dec11 make_dag");
+
+    struct arrays {
+        std::string names;
+        std::vector<u32> name_offsets{0};
+        std::vector<u32> offsets, edges, levels;
+        std::vector<std::uint64_t> level_offsets;
+    };
+    auto const a = std::make_shared<arrays>();
+
+    aoc::hash_map<std::string_view, u32> ids;
+    auto intern = [&](std::string_view name) {
+        if (ids.try_emplace(name, u32(ids.size())).second) {
+            a->names += name;
+            a->name_offsets.push_back(u32(a->names.size()));
+        }
+    };
+    for (auto const& [name, nexts] : servers) {
+        intern(name);
+        flux::for_each(nexts, intern);
+    }
+    auto const n = ids.size();
+
+    a->offsets.assign(n + 1, 0);
+    for (auto const& [name, nexts] : servers) {
+        a->offsets[ids.at(name) + 1] = u32(nexts.size());
+    }
+    std::inclusive_scan(a->offsets.begin(), a->offsets.end(),
+                        a->offsets.begin());
+
+    a->edges.resize(a->offsets.back());
+    for (auto const& [name, nexts] : servers) {
+        auto pos = a->offsets[ids.at(name)];
+        for (auto const& next : nexts) { a->edges[pos++] = ids.at(next); }
+    }
+
+    dag g{.names = a->names,
+          .name_offsets = a->name_offsets,
+          .offsets = a->offsets,
+          .edges = a->edges,
+          .storage = a};
+
+    // Reverse edges, so that we can walk upwards from the sinks
+    std::vector<u32> pred_offsets(n + 1, 0);
+    for (u32 next : g.edges) { ++pred_offsets[next + 1]; }
+    std::inclusive_scan(pred_offsets.begin(), pred_offsets.end(),
+                        pred_offsets.begin());
+    std::vector<u32> preds(g.edges.size());
+    {
+        auto fill = pred_offsets;
+        for (auto node : flux::iota(u32{0}, u32(n))) {
+            for (u32 next : g.successors(node)) { preds[fill[next]++] = node; }
+        }
+    }
+
+    // Kahn's algorithm: a node's level is final once all of its successors
+    // have been visited
+    std::vector<u32> pending(n), level(n, 0), queue;
+    queue.reserve(n);
+    for (auto node : flux::iota(u32{0}, u32(n))) {
+        pending[node] = g.offsets[node + 1] - g.offsets[node];
+        if (pending[node] == 0) { queue.push_back(node); }
+    }
+    for (std::size_t i = 0; i < queue.size(); i++) {
+        u32 node = queue[i];
+        auto const node_preds = std::span(preds).subspan(
+            pred_offsets[node], pred_offsets[node + 1] - pred_offsets[node]);
+        for (u32 pred : node_preds) {
+            level[pred] = std::max(level[pred], level[node] + 1);
+            if (--pending[pred] == 0) { queue.push_back(pred); }
+        }
+    }
+    FLUX_ASSERT(queue.size() == n); // otherwise the graph has a cycle
+
+    // Counting sort of the nodes by level
+    auto const n_levels = n == 0 ? 0 : 1 + flux::max(level).value();
+    a->level_offsets.assign(n_levels + 1, 0);
+    for (u32 l : level) { ++a->level_offsets[l + 1]; }
+    std::inclusive_scan(a->level_offsets.begin(), a->level_offsets.end(),
+                        a->level_offsets.begin());
+    a->levels.resize(n);
+    {
+        auto fill = a->level_offsets;
+        for (auto node : flux::iota(u32{0}, u32(n))) {
+            a->levels[fill[level[node]]++] = node;
+        }
+    }
+    g.levels = a->levels;
+    g.level_offsets = a->level_offsets;
+
+    return g;
+};
+
+// As count_paths, but evaluated level by level starting from the sinks.
+// Every successor of a node lies in a lower level, so the nodes within a
+// level are independent and can be spread across the thread pool, which
+// must finish each level before moving on to the next one.
+// Counts are 128-bit, as path counts in large graphs easily overflow i64.
+static u128
+count_paths_parallel(dag const& g, std::string_view from, std::string_view to,
+                     std::span<std::string_view const> waypoints = {})
+{
+    auto const n_masks = std::size_t{1} << waypoints.size();
+    auto const to_id = g.id(to);
+    auto const waypoint_ids = flux::map(waypoints, [&](std::string_view w) {
+                                  return g.id(w);
+                              }).to<std::vector>();
+
+    std::vector<u128> counts(g.size() * n_masks);
+
+    auto const eval_node = [&](u32 node) {
+        auto out = std::span(counts).subspan(node * n_masks, n_masks);
+
+        std::size_t bit = 0;
+        if (auto idx = flux::find(waypoint_ids, node);
+            idx < flux::size(waypoint_ids)) {
+            bit = std::size_t{1} << idx;
+        }
+
+        if (node == to_id) {
+            out[bit] = 1;
+            return;
+        }
+
+        for (u32 next : g.successors(node)) {
+            auto const* in = counts.data() + next * n_masks;
+            for (auto m : flux::iota(0uz, n_masks)) { out[m] += in[m]; }
+        }
+
+        // Visiting this node sets its bit in every mask
+        if (bit != 0) {
+            for (auto m : flux::iota(0uz, n_masks)) {
+                if (m & bit) { out[m] += out[m ^ bit]; }
+            }
+            for (auto m : flux::iota(0uz, n_masks)) {
+                if (!(m & bit)) { out[m] = 0; }
+            }
+        }
+    };
+
+    for (auto level : flux::iota(0uz, g.level_offsets.size() - 1)) {
+        auto const nodes = g.levels.subspan(
+            g.level_offsets[level],
+            g.level_offsets[level + 1] - g.level_offsets[level]);
+        aoc::parallel_for(nodes.size(),
+                          [&](std::size_t i) { eval_node(nodes[i]); });
+    }
+
+    return counts[g.id(from) * n_masks + n_masks - 1];
+}
+
+auto const part1 = [](dag const& graph) {
+    return count_paths_parallel(graph, "you", "out");
+};
+
+auto const part2 = [](dag const& graph) {
+    std::array<std::string_view, 2> const waypoints{"fft", "dac"};
+    return count_paths_parallel(graph, "svr", "out", waypoints);
 };
 
 constexpr auto& test_data1 = R"(aaa: you hhh
@@ -84,16 +340,49 @@ hhh: out
 int main(int argc, char** argv)
 {
     // Alas, no constexpr tests today
-    FLUX_ASSERT(part1(parse_input(test_data1)) == 5);
-    FLUX_ASSERT(part2(parse_input(test_data2)) == 2);
+    FLUX_ASSERT(count_paths(parse_input(test_data1), "you", "out") == 5);
+    FLUX_ASSERT(part1(make_dag(parse_input(test_data1))) == 5);
+    FLUX_ASSERT(part2(make_dag(parse_input(test_data2))) == 2);
+
+    // The serial version is the reference for the parallel one
+    std::array<std::string_view, 2> const waypoints{"fft", "dac"};
+    auto const servers = parse_input(test_data2);
+    auto const graph = make_dag(servers);
+    FLUX_ASSERT(count_paths(servers, "svr", "out", waypoints) == 2);
+    for (auto const& [from, to] :
+         {std::pair{"svr", "out"}, {"svr", "fft"}, {"fft", "dac"}}) {
+        FLUX_ASSERT(u128(count_paths(servers, from, to, waypoints))
+                    == count_paths_parallel(graph, from, to, waypoints));
+    }
 
     if (argc < 2) {
         std::println(std::cerr, "No input");
         return -1;
     }
 
-    auto const input = parse_input(aoc::string_from_file(argv[1]));
-    std::println("Part 1: {}", part1(input));
-    auto [res, time] = aoc::timed(part2, input);
-    std::println("Part 2: {} ({})", res, time);
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(
+            [](std::string_view text, aoc::arena& arena) {
+                return make_dag(parse_input(text, arena));
+            },
+            [](dag const& graph) {
+                return std::format("Part 1: {}\nPart 2: {}", part1(graph),
+                                   part2(graph));
+            });
+    }
+
+    auto const text = aoc::string_from_file(argv[1]);
+
+    // With AOC_CACHE_DIR set, the graph is built once and then mapped back in
+    // by later runs on the same input
+    auto input = dag::load(text);
+    if (!input) {
+        aoc::arena arena;
+        input = make_dag(parse_input(text, arena));
+        input->save(text);
+    }
+    std::println("Part 1: {}", part1(*input));
+    auto [res, time] = aoc::timed(part2, *input);
+    std::println("Part 2: {}", res);
+    std::println(std::cerr, "Time: {}", time);
 }
\ No newline at end of file
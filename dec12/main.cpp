@@ -1,71 +1,343 @@
 
+#include <flux/macros.hpp>
+
 import aoc;
 
+using u64 = std::uint64_t;
+
+// A single rotation or reflection of a present, as a bitmask per row: bit `x`
+// of rows[y] is set if the present covers cell (x, y). The anchor is the
+// column of the first covered cell in the top row.
+struct orientation {
+    std::array<u64, 3> rows{};
+    int width = 0;
+    int height = 0;
+    int anchor = 0;
+
+    friend auto operator==(orientation const&, orientation const&)
+        -> bool = default;
+};
+
+struct shape_t {
+    int size;
+    std::vector<orientation> orientations;
+};
+
 struct grid_t {
-    int area;
-    std::vector<int> shape_counts;
+    int width;
+    int height;
+    aoc::arena_vector<int> shape_counts;
+};
+
+auto const make_shape = [](std::array<std::string_view, 3> const& lines) {
+    shape_t shape{.size = int(flux::ref(lines)
+                                  .map([](std::string_view line) {
+                                      return flux::count_eq(line, '#');
+                                  })
+                                  .sum())};
+
+    // Bit 0 flips x, bit 1 flips y, bit 2 transposes
+    for (int t : flux::ints(0, 8)) {
+        auto covered = [&](int x, int y) {
+            if (t & 4) { std::swap(x, y); }
+            if (t & 1) { x = 2 - x; }
+            if (t & 2) { y = 2 - y; }
+            return lines[y][x] == '#';
+        };
+
+        int min_x = 3, min_y = 3, max_x = -1, max_y = -1;
+        for (int y : flux::ints(0, 3)) {
+            for (int x : flux::ints(0, 3)) {
+                if (covered(x, y)) {
+                    min_x = std::min(min_x, x);
+                    max_x = std::max(max_x, x);
+                    min_y = std::min(min_y, y);
+                    max_y = std::max(max_y, y);
+                }
+            }
+        }
+
+        orientation o{.width = 1 + max_x - min_x, .height = 1 + max_y - min_y};
+        for (int y : flux::ints(min_y, max_y + 1)) {
+            for (int x : flux::ints(min_x, max_x + 1)) {
+                if (covered(x, y)) {
+                    o.rows[y - min_y] |= u64{1} << (x - min_x);
+                }
+            }
+        }
+        o.anchor = std::countr_zero(o.rows[0]);
+
+        if (!flux::contains(shape.orientations, o)) {
+            shape.orientations.push_back(o);
+        }
+    }
+
+    return shape;
 };
 
-auto const parse_input = [](std::string_view input) {
-    std::array<int, 6> shape_sizes;
-    for (int i : flux::ints(0, 6)) {
+auto const parse_input = [](std::string_view input,
+                            aoc::arena_allocator<> alloc = {}) {
+    std::vector<shape_t> shapes;
+    for (int _ : flux::ints(0, 6)) {
         input.remove_prefix(input.find_first_of(".#"));
-        shape_sizes[i]
-            = flux::filter(input, flux::pred::neq('\n')).take(9).count_eq('#');
+        shapes.push_back(make_shape(
+            {input.substr(0, 3), input.substr(4, 3), input.substr(8, 3)}));
         input.remove_prefix(input.find("\n\n") + 2);
     }
 
-    auto grids
-        = flux::split_string(input, '\n')
-              .filter([](std::string_view line) { return !line.empty(); })
-              .map([](std::string_view line) {
-                  auto x = line.find('x');
-                  auto colon = line.find(':');
-                  return grid_t{
-                      .area = aoc::parse<int>(line.substr(0, x))
-                          * aoc::parse<int>(line.substr(x + 1, colon)),
-                      .shape_counts
-                      = flux::split_string(line.substr(colon + 2), ' ')
-                            .map(aoc::parse<int>)
-                            .to<std::vector>()};
-              })
-              .to<std::vector>();
+    aoc::arena_vector<grid_t> grids(alloc);
+    for (aoc::scanner sc(input); !sc.skip_whitespace().at_end();) {
+        auto const width = sc.read<int>();
+        auto const height = sc.expect('x').read<int>();
+        sc.expect(':');
+        aoc::arena_vector<int> counts(alloc);
+        while (!sc.at_eol()) { counts.push_back(sc.read<int>()); }
+        grids.push_back(grid_t{width, height, std::move(counts)});
+    }
 
-    return std::pair(shape_sizes, std::move(grids));
+    return std::pair(std::move(shapes), std::move(grids));
 };
 
-auto const solve = [](std::array<int, 6> const& shape_sizes,
-                      std::vector<grid_t> const& grids) -> std::optional<int> {
-    auto trivially_solvable = flux::count_if(grids, [](grid_t const& grid) {
-        return grid.area >= 9 * flux::sum(grid.shape_counts);
-    });
+// Backtracking packer over a bit-packed board. Cells are visited in row-major
+// order, and the first empty cell must either be covered by the anchor of
+// some present, or left empty for good. Identical presents are only counted,
+// never permuted, and the number of cells we can afford to leave empty
+// ("slack") bounds the search.
+//
+// Everything before the current cell is filled, and nothing below the next
+// three rows has been touched yet, so those rows plus the presents left
+// describe the rest of the search. States which failed are remembered, and
+// the search gives up after a fixed number of steps rather than run for
+// ever on a hard region.
+struct packer {
+    struct state {
+        std::array<u64, 3> rows;
+        std::uint32_t cell;
+        std::array<std::uint16_t, 6> remaining;
+
+        friend auto operator==(state const&, state const&) -> bool = default;
+    };
+
+    struct state_hash {
+        using is_avalanching = void;
+
+        auto operator()(state const& s) const -> u64
+        {
+            return ankerl::unordered_dense::hash<std::string_view>{}(
+                std::string_view(reinterpret_cast<char const*>(&s),
+                                 sizeof(s)));
+        }
+    };
+
+    std::span<shape_t const> shapes;
+    int width;
+    int height;
+    std::vector<u64> board;
+    std::array<std::uint16_t, 6> remaining;
+    long budget = 1 << 20;
+    ankerl::unordered_dense::set<state, state_hash> dead_ends{};
+
+    auto filled(int cell) const -> bool
+    {
+        return (board[cell / width] >> (cell % width)) & 1;
+    }
+
+    auto fits(orientation const& o, int x, int y) const -> bool
+    {
+        if (x < 0 || x + o.width > width || y + o.height > height) {
+            return false;
+        }
+        return flux::ints(0, o.height).all([&](int r) {
+            return (board[y + r] & (o.rows[r] << x)) == 0;
+        });
+    }
+
+    void toggle(orientation const& o, int x, int y)
+    {
+        for (int r : flux::ints(0, o.height)) {
+            board[y + r] ^= o.rows[r] << x;
+        }
+    }
+
+    auto key(int cell) const -> state
+    {
+        state s{.rows = {},
+                .cell = std::uint32_t(cell),
+                .remaining = remaining};
+        for (int r : flux::ints(0, std::min(3, height - cell / width))) {
+            s.rows[r] = board[cell / width + r];
+        }
+        return s;
+    }
 
-    auto impossible = flux::count_if(grids, [&](grid_t const& grid) {
-        auto min_reqd = flux::map(flux::ints(0, 6), [&](int idx) {
-                            return grid.shape_counts[idx] * shape_sizes[idx];
-                        }).sum();
-        return grid.area < min_reqd;
+    // Empty cells with no empty neighbours can never be covered, so each
+    // one uses up a cell of slack. Rows above `y` are full, and rows more
+    // than two below it are empty.
+    auto isolated_cells(int y) const -> int
+    {
+        u64 const all = width == 64 ? ~u64{0} : (u64{1} << width) - 1;
+        auto empty = [&](int r) -> u64 {
+            return r < 0 || r >= height ? 0 : ~board[r] & all;
+        };
+
+        int count = 0;
+        for (int r : flux::ints(y, std::min(y + 3, height))) {
+            u64 const e = empty(r);
+            count += std::popcount(e & ~(e << 1) & ~(e >> 1) & ~empty(r - 1)
+                                   & ~empty(r + 1));
+        }
+        return count;
+    }
+
+    // Returns nullopt if we ran out of budget before finding an answer
+    auto search(int cell, int n_left, int slack) -> std::optional<bool>
+    {
+        if (n_left == 0) { return true; }
+
+        while (cell < width * height && filled(cell)) { ++cell; }
+        if (cell == width * height) { return false; }
+        if (budget-- == 0) { return std::nullopt; }
+
+        int const x = cell % width;
+        int const y = cell / width;
+        auto const k = key(cell);
+        if (dead_ends.contains(k) || isolated_cells(y) > slack) {
+            return false;
+        }
+
+        for (auto idx : flux::iota(0uz, shapes.size())) {
+            if (remaining[idx] == 0) { continue; }
+            for (orientation const& o : shapes[idx].orientations) {
+                if (!fits(o, x - o.anchor, y)) { continue; }
+                toggle(o, x - o.anchor, y);
+                --remaining[idx];
+                auto const found = search(cell + 1, n_left - 1, slack);
+                ++remaining[idx];
+                toggle(o, x - o.anchor, y);
+                if (found != false) { return found; }
+            }
+        }
+
+        if (slack > 0) {
+            board[y] ^= u64{1} << x;
+            auto const found = search(cell + 1, n_left, slack - 1);
+            board[y] ^= u64{1} << x;
+            if (found != false) { return found; }
+        }
+
+        dead_ends.insert(k);
+        return false;
+    }
+};
+
+// Returns nullopt if the region is too big for the board representation, or
+// too hard to decide within the packer's budget
+auto const can_pack = [](std::span<shape_t const> shapes,
+                         grid_t const& grid) -> std::optional<bool> {
+    auto const n_presents = flux::sum(grid.shape_counts);
+    auto const required
+        = flux::iota(0uz, shapes.size())
+              .map([&](auto idx) {
+                  return shapes[idx].size * grid.shape_counts[idx];
+              })
+              .sum();
+    auto const area = grid.width * grid.height;
+
+    if (area < required) { return false; }
+    if ((grid.width / 3) * (grid.height / 3) >= n_presents) { return true; }
+
+    // Scanning along the short side finds dead ends much sooner
+    auto const [width, height] = std::minmax(grid.width, grid.height);
+    if (width > 64 || grid.shape_counts.size() != 6) { return std::nullopt; }
+
+    packer p{.shapes = shapes,
+             .width = width,
+             .height = height,
+             .board = std::vector<u64>(height),
+             .remaining = {}};
+    for (auto idx : flux::iota(0uz, 6uz)) {
+        if (grid.shape_counts[idx] > 0xffff) { return std::nullopt; }
+        p.remaining[idx] = std::uint16_t(grid.shape_counts[idx]);
+    }
+    return p.search(0, n_presents, area - required);
+};
+
+// Each region is independent, so they can be packed concurrently
+auto const solve = [](std::vector<shape_t> const& shapes,
+                      aoc::arena_vector<grid_t> const& grids)
+    -> std::optional<int> {
+    std::vector<std::optional<bool>> results(grids.size());
+    aoc::parallel_for(grids.size(), [&](std::size_t i) {
+        results[i] = can_pack(shapes, grids[i]);
     });
 
-    if (trivially_solvable + impossible == grids.size()) {
-        return trivially_solvable;
-    } else {
+    if (!flux::all(results, [](auto r) { return r.has_value(); })) {
         return std::nullopt;
     }
+    return flux::count_if(results, [](auto r) { return *r; });
 };
 
+constexpr auto& test_data = R"(0:
+###
+##.
+##.
+
+1:
+###
+##.
+.##
+
+2:
+.##
+###
+##.
+
+3:
+##.
+###
+##.
+
+4:
+###
+#..
+###
+
+5:
+###
+.#.
+###
+
+4x4: 0 0 0 0 2 0
+12x5: 1 0 1 0 2 2
+12x5: 1 0 1 0 3 2
+)";
+
 int main(int argc, char** argv)
 {
+    // Threads aren't allowed in constant expressions
+    FLUX_ASSERT(std::apply(solve, parse_input(test_data)) == 2);
+
     if (argc < 2) {
         std::println(std::cerr, "No input");
         return -1;
     }
 
-    auto const [sizes, grids] = parse_input(aoc::string_from_file(argv[1]));
+    if (argv[1] == std::string_view("--serve")) {
+        return aoc::serve(parse_input, [](auto const& input) {
+            if (auto soln = std::apply(solve, input)) {
+                return std::format("Solution: {}", *soln);
+            }
+            return std::string("Could not solve: some regions are undecided");
+        });
+    }
+
+    aoc::arena arena;
+    auto const [shapes, grids]
+        = parse_input(aoc::string_from_file(argv[1]), arena);
 
-    if (auto soln = solve(sizes, grids)) {
+    if (auto soln = solve(shapes, grids)) {
         std::println("Solution: {}", *soln);
     } else {
-        std::println("Could not find a simple solution");
+        std::println("Could not solve: some regions are undecided");
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,287 @@
+
+import aoc;
+
+namespace {
+
+using u64 = std::uint64_t;
+
+using rng = aoc::splitmix64;
+
+auto const pow10 = [](u64 exponent) -> u64 {
+    u64 result = 1;
+    for (auto _ : flux::iota(0uz, exponent)) { result *= 10; }
+    return result;
+};
+
+auto const append = [](std::ostream& out, auto const&... args) {
+    (out << ... << args);
+};
+
+// n rotations
+auto const gen_dec01 = [](rng& r, std::size_t n, std::ostream& out) {
+    for (auto _ : flux::iota(0uz, n)) {
+        append(out, r.chance(0.5) ? 'L' : 'R', r.between(1, 999), '\n');
+    }
+};
+
+// n id ranges
+auto const gen_dec02 = [](rng& r, std::size_t n, std::ostream& out) {
+    for (auto i : flux::iota(0uz, n)) {
+        u64 lo = r.between(1, 9'999'990'000);
+        append(out, i == 0 ? "" : ",", lo, '-', lo + r.between(0, 10'000));
+    }
+    out << '\n';
+};
+
+// n battery banks
+auto const gen_dec03 = [](rng& r, std::size_t n, std::ostream& out) {
+    for (auto _ : flux::iota(0uz, n)) {
+        for (auto _ : flux::iota(0, 100)) {
+            out << char('0' + r.between(1, 9));
+        }
+        out << '\n';
+    }
+};
+
+// An n x n grid
+auto const gen_dec04 = [](rng& r, std::size_t n, std::ostream& out) {
+    for (auto _ : flux::iota(0uz, n)) {
+        for (auto _ : flux::iota(0uz, n)) {
+            out << (r.chance(0.6) ? '@' : '.');
+        }
+        out << '\n';
+    }
+};
+
+// n ranges and n ids, about half of which are fresh
+auto const gen_dec05 = [](rng& r, std::size_t n, std::ostream& out) {
+    std::vector<std::pair<u64, u64>> ranges;
+    for (auto _ : flux::iota(0uz, n)) {
+        u64 lo = r.between(1, 1'000'000'000'000'000);
+        ranges.emplace_back(lo, lo + r.between(0, 1'000'000'000'000));
+        append(out, lo, '-', ranges.back().second, '\n');
+    }
+    out << '\n';
+    for (auto _ : flux::iota(0uz, n)) {
+        if (r.chance(0.5)) {
+            auto [lo, hi] = ranges[r.between(0, n - 1)];
+            append(out, r.between(lo, hi), '\n');
+        } else {
+            append(out, r.between(1, 1'000'000'000'000'000), '\n');
+        }
+    }
+};
+
+// n problems of four numbers each. Within a problem the numbers are padded
+// to the same width, and sorted by length so that every column of digits is
+// unbroken when read top to bottom.
+auto const gen_dec06 = [](rng& r, std::size_t n, std::ostream& out) {
+    std::array<std::string, 5> rows;
+    for (auto i : flux::iota(0uz, n)) {
+        auto const width = r.between(1, 4);
+        bool const left_align = r.chance(0.5);
+
+        std::array<u64, 4> lengths;
+        for (u64& len : lengths) { len = r.between(1, width); }
+        lengths[0] = width;
+        if (left_align) {
+            std::ranges::sort(lengths, std::greater{});
+        } else {
+            std::ranges::sort(lengths);
+        }
+
+        for (auto row : flux::iota(0uz, 4uz)) {
+            if (i != 0) { rows[row] += ' '; }
+            auto const len = lengths[row];
+            u64 value = r.between(pow10(len - 1), pow10(len) - 1);
+            auto const pad = std::string(width - len, ' ');
+            rows[row] += std::format("{}{}{}", left_align ? "" : pad, value,
+                                     left_align ? pad : "");
+        }
+
+        if (i != 0) { rows[4] += ' '; }
+        rows[4] += r.chance(0.5) ? '+' : '*';
+        rows[4] += std::string(width - 1, ' ');
+    }
+    for (auto const& row : rows) { append(out, row, '\n'); }
+};
+
+// An n x n manifold, with splitters on every other row
+auto const gen_dec07 = [](rng& r, std::size_t n, std::ostream& out) {
+    n = std::max(n, 3uz);
+    for (auto row : flux::iota(0uz, n)) {
+        for (auto col : flux::iota(0uz, n)) {
+            if (row == 0) {
+                out << (col == n / 2 ? 'S' : '.');
+            } else if (row % 2 == 0 && col > 0 && col < n - 1
+                       && r.chance(0.3)) {
+                out << '^';
+            } else {
+                out << '.';
+            }
+        }
+        out << '\n';
+    }
+};
+
+// n junction boxes. Part 1 makes 1000 connections, so n should be at least 50
+auto const gen_dec08 = [](rng& r, std::size_t n, std::ostream& out) {
+    for (auto _ : flux::iota(0uz, n)) {
+        append(out, r.between(0, 99'999), ',', r.between(0, 99'999), ',',
+               r.between(0, 99'999), '\n');
+    }
+};
+
+// A rectilinear polygon with about n corners: a "histogram" of columns of
+// random heights standing on a common base
+auto const gen_dec09 = [](rng& r, std::size_t n, std::ostream& out) {
+    auto const n_cols = std::max(n / 2, 2uz) - 1;
+    u64 const base = 1;
+
+    u64 x = r.between(1, 1000);
+    u64 height = 0;
+    append(out, x, ',', base, '\n');
+    for (auto _ : flux::iota(0uz, n_cols)) {
+        u64 next_height = height;
+        while (next_height == height) {
+            next_height = r.between(base + 1, 100'000);
+        }
+        append(out, x, ',', next_height, '\n');
+        x += r.between(1, 2000);
+        append(out, x, ',', next_height, '\n');
+        height = next_height;
+    }
+    append(out, x, ',', base, '\n');
+};
+
+// A DAG with n nodes and about 2.5n edges. Edges only go forwards, and never
+// very far, so that there are plenty of long paths.
+auto const gen_dec11 = [](rng& r, std::size_t n, std::ostream& out) {
+    n = std::max(n, 6uz);
+    auto const fft = std::max(n / 3, 2uz);
+    auto const dac = std::max(2 * n / 3, 3uz);
+
+    auto name = [&](std::size_t i) -> std::string {
+        if (i == 0) { return "svr"; }
+        if (i == 1) { return "you"; }
+        if (i == fft) { return "fft"; }
+        if (i == dac) { return "dac"; }
+        if (i == n - 1) { return "out"; }
+        // Four or more letters, so never one of the names above
+        std::string s;
+        for (auto j = i; s.size() < 4 || j > 0; j /= 26) {
+            s += char('a' + j % 26);
+        }
+        return s;
+    };
+
+    std::vector<std::size_t> nexts;
+    for (auto i : flux::iota(0uz, n - 1)) {
+        nexts.clear();
+        auto const limit = std::min(n - 1, i + 64);
+        for (auto _ : flux::iota(0u, unsigned(r.between(1, 4)))) {
+            auto next = r.between(i + 1, limit);
+            if (!flux::contains(nexts, next)) { nexts.push_back(next); }
+        }
+        append(out, name(i), ':');
+        for (auto next : nexts) { append(out, ' ', name(next)); }
+        out << '\n';
+    }
+};
+
+// n regions which are either trivially solvable or too small by area, as in
+// the real puzzle inputs
+auto const gen_dec12 = [](rng& r, std::size_t n, std::ostream& out) {
+    out << R"(0:
+###
+##.
+##.
+
+1:
+###
+##.
+.##
+
+2:
+.##
+###
+##.
+
+3:
+##.
+###
+##.
+
+4:
+###
+#..
+###
+
+5:
+###
+.#.
+###
+
+)";
+
+    for (auto _ : flux::iota(0uz, n)) {
+        auto const width = r.between(35, 50);
+        auto const height = r.between(35, 50);
+        // Every present covers 7 cells
+        auto const n_presents = r.chance(0.5)
+            ? r.between((width / 3) * (height / 3) / 2,
+                        (width / 3) * (height / 3))
+            : width * height / 7 + r.between(1, 20);
+
+        std::array<u64, 6> counts{};
+        for (auto _ : flux::iota(0uz, n_presents)) {
+            ++counts[r.between(0, 5)];
+        }
+        append(out, width, 'x', height, ':');
+        for (u64 c : counts) { append(out, ' ', c); }
+        out << '\n';
+    }
+};
+
+using generator_fn = void (*)(rng&, std::size_t, std::ostream&);
+
+constexpr std::array<std::pair<std::string_view, generator_fn>, 11> generators{
+    {{"dec01", gen_dec01},
+     {"dec02", gen_dec02},
+     {"dec03", gen_dec03},
+     {"dec04", gen_dec04},
+     {"dec05", gen_dec05},
+     {"dec06", gen_dec06},
+     {"dec07", gen_dec07},
+     {"dec08", gen_dec08},
+     {"dec09", gen_dec09},
+     {"dec11", gen_dec11},
+     {"dec12", gen_dec12}}};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::println(std::cerr, "Usage: generate <day> <size> [seed]");
+        return -1;
+    }
+
+    auto const day = std::string_view(argv[1]);
+    auto const gen = flux::find_if(generators, [&](auto const& entry) {
+        return entry.first == day;
+    });
+    if (gen == flux::size(generators)) {
+        std::println(std::cerr, "No generator for {}", day);
+        return -1;
+    }
+
+    auto const size = aoc::parse<std::size_t>(std::string_view(argv[2]));
+    auto const seed = argc > 3 ? aoc::parse<u64>(std::string_view(argv[3])) : 0;
+
+    // Written straight to stdout, as the largest inputs run to hundreds of
+    // megabytes
+    std::ios::sync_with_stdio(false);
+    rng r{seed};
+    generators[gen].second(r, size, std::cout);
+}